@@ -0,0 +1,316 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "CombatAudioSubsystem.h"
+#include "Components/AudioComponent.h"
+#include "Sound/SoundBase.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommandWithWorld GDumpCombatAudioStatsCommand(
+	TEXT("CombatAudio.DumpStats"),
+	TEXT("Logs requests, culled requests, stolen and active voices and pool usage per combat sound category."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (World && World->GetSubsystem<UCombatAudioSubsystem>())
+		{
+			World->GetSubsystem<UCombatAudioSubsystem>()->DumpStats();
+		}
+	}));
+
+UCombatAudioSubsystem::UCombatAudioSubsystem() : MaxTotalVoices(24), PrewarmCount(4)
+{
+	FCombatSoundCategorySettings& WeaponFire = CategorySettings[static_cast<int32>(ECombatSoundCategory::ECSC_WeaponFire)];
+	WeaponFire.MaxVoices = 4;
+	WeaponFire.Priority = 3;
+
+	FCombatSoundCategorySettings& Impact = CategorySettings[static_cast<int32>(ECombatSoundCategory::ECSC_Impact)];
+	Impact.MaxVoices = 8;
+	Impact.MaxDistance = 4000.f;
+	Impact.Priority = 1;
+
+	FCombatSoundCategorySettings& Melee = CategorySettings[static_cast<int32>(ECombatSoundCategory::ECSC_Melee)];
+	Melee.MaxVoices = 6;
+	Melee.MaxDistance = 3000.f;
+	Melee.Priority = 2;
+
+	FCombatSoundCategorySettings& Interface = CategorySettings[static_cast<int32>(ECombatSoundCategory::ECSC_Interface)];
+	Interface.MaxVoices = 2;
+	Interface.Priority = 4;
+}
+
+void UCombatAudioSubsystem::Deinitialize()
+{
+	for (FCombatSoundPool& Pool : Pools)
+	{
+		for (UAudioComponent* Component : Pool.Free)
+		{
+			if (Component)
+			{
+				Component->DestroyComponent();
+			}
+		}
+		for (UAudioComponent* Component : Pool.Active)
+		{
+			if (Component)
+			{
+				Component->DestroyComponent();
+			}
+		}
+		Pool = FCombatSoundPool();
+	}
+	PreloadedSounds.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCombatAudioSubsystem::PreloadSound(USoundBase* Sound, ECombatSoundCategory Category)
+{
+	if (Sound == nullptr || Category == ECombatSoundCategory::ECSC_MAX) return;
+
+	if (!PreloadedSounds.Contains(Sound))
+	{
+		//loads the first chunk of streamed waves so the first play doesn't wait on disk
+		UGameplayStatics::PrimeSound(Sound);
+		PreloadedSounds.Add(Sound);
+	}
+
+	FCombatSoundPool& Pool = Pools[static_cast<int32>(Category)];
+	const int32 TargetCount{ FMath::Min(PrewarmCount, CategorySettings[static_cast<int32>(Category)].MaxVoices) };
+	while (Pool.Free.Num() + Pool.Active.Num() < TargetCount)
+	{
+		UAudioComponent* Component = CreatePooledComponent();
+		if (Component == nullptr) break;
+
+		Pool.Free.Add(Component);
+		Pool.Stats.PooledComponents++;
+	}
+}
+
+bool UCombatAudioSubsystem::PlaySound2D(USoundBase* Sound, ECombatSoundCategory Category)
+{
+	return PlaySound(Sound, nullptr, Category);
+}
+
+bool UCombatAudioSubsystem::PlaySoundAtLocation(USoundBase* Sound, const FVector& Location, ECombatSoundCategory Category)
+{
+	return PlaySound(Sound, &Location, Category);
+}
+
+bool UCombatAudioSubsystem::PlaySound(USoundBase* Sound, const FVector* Location, ECombatSoundCategory Category)
+{
+	if (Sound == nullptr || Category == ECombatSoundCategory::ECSC_MAX) return false;
+
+	const FCombatSoundCategorySettings& Settings = CategorySettings[static_cast<int32>(Category)];
+	FCombatSoundPool& Pool = Pools[static_cast<int32>(Category)];
+	Pool.Stats.Requests++;
+
+	//2D sounds count as being at the listener
+	float DistanceSquared{ 0.f };
+	FVector ListenerLocation;
+	if (Location && GetListenerLocation(ListenerLocation))
+	{
+		DistanceSquared = FVector::DistSquared(*Location, ListenerLocation);
+		if (Settings.MaxDistance > 0.f && DistanceSquared > FMath::Square(Settings.MaxDistance))
+		{
+			Pool.Stats.DistanceCulled++;
+			return false;
+		}
+	}
+
+	if (!MakeRoom(Pool, Category, DistanceSquared))
+	{
+		Pool.Stats.BudgetCulled++;
+		return false;
+	}
+
+	UAudioComponent* Component = AcquireComponent(Pool);
+	if (Component == nullptr)
+	{
+		Pool.Stats.BudgetCulled++;
+		return false;
+	}
+
+	Component->bAllowSpatialization = Location != nullptr;
+	Component->bIsUISound = Location == nullptr;
+	if (Location)
+	{
+		Component->SetWorldLocation(*Location);
+	}
+	Component->SetSound(Sound);
+	Component->Play();
+
+	Pool.Active.Add(Component);
+	Pool.Stats.ActiveVoices = Pool.Active.Num();
+	Pool.Stats.PeakVoices = FMath::Max(Pool.Stats.PeakVoices, Pool.Stats.ActiveVoices);
+	return true;
+}
+
+bool UCombatAudioSubsystem::MakeRoom(FCombatSoundPool& Pool, ECombatSoundCategory Category, float RequestDistanceSquared)
+{
+	const FCombatSoundCategorySettings& Settings = CategorySettings[static_cast<int32>(Category)];
+
+	//full category: replace its farthest voice (the oldest one among equally distant 2D voices) if the request is closer
+	if (Pool.Active.Num() >= Settings.MaxVoices)
+	{
+		int32 FarthestIndex{ INDEX_NONE };
+		float FarthestDistanceSquared{ -1.f };
+		for (int32 i = 0; i < Pool.Active.Num(); i++)
+		{
+			const float DistanceSquared{ GetDistanceSquaredToListener(Pool.Active[i]) };
+			if (DistanceSquared > FarthestDistanceSquared)
+			{
+				FarthestIndex = i;
+				FarthestDistanceSquared = DistanceSquared;
+			}
+		}
+		if (FarthestIndex == INDEX_NONE || FarthestDistanceSquared < RequestDistanceSquared) return false;
+
+		StopVoice(Pool, FarthestIndex);
+		return true;
+	}
+
+	//full budget: take the oldest voice of the least important category below this one
+	int32 TotalVoices{ 0 };
+	for (const FCombatSoundPool& CategoryPool : Pools)
+	{
+		TotalVoices += CategoryPool.Active.Num();
+	}
+	if (TotalVoices < MaxTotalVoices) return true;
+
+	int32 VictimCategory{ INDEX_NONE };
+	for (int32 i = 0; i < static_cast<int32>(ECombatSoundCategory::ECSC_MAX); i++)
+	{
+		if (Pools[i].Active.Num() == 0 || CategorySettings[i].Priority >= Settings.Priority) continue;
+
+		if (VictimCategory == INDEX_NONE || CategorySettings[i].Priority < CategorySettings[VictimCategory].Priority)
+		{
+			VictimCategory = i;
+		}
+	}
+	if (VictimCategory == INDEX_NONE) return false;
+
+	StopVoice(Pools[VictimCategory], 0);
+	return true;
+}
+
+void UCombatAudioSubsystem::StopVoice(FCombatSoundPool& Pool, int32 ActiveIndex)
+{
+	UAudioComponent* Component = Pool.Active[ActiveIndex];
+	Pool.Active.RemoveAt(ActiveIndex, 1, false);
+	Pool.Stats.Stolen++;
+	Pool.Stats.ActiveVoices = Pool.Active.Num();
+
+	if (Component)
+	{
+		Component->Stop();
+		Pool.Free.Add(Component);
+	}
+}
+
+UAudioComponent* UCombatAudioSubsystem::AcquireComponent(FCombatSoundPool& Pool)
+{
+	if (Pool.Free.Num() > 0)
+	{
+		return Pool.Free.Pop(false);
+	}
+
+	UAudioComponent* Component = CreatePooledComponent();
+	if (Component)
+	{
+		Pool.Stats.PooledComponents++;
+	}
+	return Component;
+}
+
+UAudioComponent* UCombatAudioSubsystem::CreatePooledComponent()
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->GetWorldSettings() == nullptr) return nullptr;
+
+	UAudioComponent* Component = NewObject<UAudioComponent>(World->GetWorldSettings(), NAME_None, RF_Transient);
+	Component->bAutoActivate = false;
+	Component->bAutoDestroy = false;
+	Component->bStopWhenOwnerDestroyed = false;
+	Component->SetUsingAbsoluteLocation(true);
+	Component->OnAudioFinishedNative.AddUObject(this, &UCombatAudioSubsystem::OnPooledAudioFinished);
+	Component->RegisterComponentWithWorld(World);
+
+	return Component;
+}
+
+void UCombatAudioSubsystem::OnPooledAudioFinished(UAudioComponent* Component)
+{
+	//a stolen voice may already be playing its next sound by the time its old one reports finishing
+	if (Component == nullptr || Component->IsPlaying()) return;
+
+	for (FCombatSoundPool& Pool : Pools)
+	{
+		if (Pool.Active.RemoveSingle(Component) > 0)
+		{
+			Pool.Free.Add(Component);
+			Pool.Stats.ActiveVoices = Pool.Active.Num();
+			return;
+		}
+	}
+}
+
+bool UCombatAudioSubsystem::GetListenerLocation(FVector& OutLocation) const
+{
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr) return false;
+
+	FVector FrontDir;
+	FVector RightDir;
+	PlayerController->GetAudioListenerPosition(OutLocation, FrontDir, RightDir);
+	return true;
+}
+
+float UCombatAudioSubsystem::GetDistanceSquaredToListener(const UAudioComponent* Component) const
+{
+	FVector ListenerLocation;
+	if (Component == nullptr || !Component->bAllowSpatialization || !GetListenerLocation(ListenerLocation)) return 0.f;
+
+	return FVector::DistSquared(Component->GetComponentLocation(), ListenerLocation);
+}
+
+FCombatSoundStats UCombatAudioSubsystem::GetCategoryStats(ECombatSoundCategory Category) const
+{
+	return Category != ECombatSoundCategory::ECSC_MAX ? Pools[static_cast<int32>(Category)].Stats : FCombatSoundStats();
+}
+
+FCombatSoundStats UCombatAudioSubsystem::GetTotalStats() const
+{
+	FCombatSoundStats Total;
+	for (const FCombatSoundPool& Pool : Pools)
+	{
+		Total.Requests += Pool.Stats.Requests;
+		Total.DistanceCulled += Pool.Stats.DistanceCulled;
+		Total.BudgetCulled += Pool.Stats.BudgetCulled;
+		Total.Stolen += Pool.Stats.Stolen;
+		Total.ActiveVoices += Pool.Stats.ActiveVoices;
+		Total.PeakVoices += Pool.Stats.PeakVoices;
+		Total.PooledComponents += Pool.Stats.PooledComponents;
+	}
+	return Total;
+}
+
+void UCombatAudioSubsystem::DumpStats() const
+{
+	const UEnum* CategoryEnum = StaticEnum<ECombatSoundCategory>();
+	for (int32 i = 0; i < static_cast<int32>(ECombatSoundCategory::ECSC_MAX); i++)
+	{
+		const FCombatSoundStats& Stats = Pools[i].Stats;
+		UE_LOG(LogTemp, Log, TEXT("Combat audio %s: requests %d, distance culled %d, budget culled %d, stolen %d, active %d/%d, peak %d, pooled %d"),
+			*CategoryEnum->GetDisplayNameTextByIndex(i).ToString(), Stats.Requests, Stats.DistanceCulled, Stats.BudgetCulled,
+			Stats.Stolen, Stats.ActiveVoices, CategorySettings[i].MaxVoices, Stats.PeakVoices, Stats.PooledComponents);
+	}
+
+	const FCombatSoundStats Total{ GetTotalStats() };
+	UE_LOG(LogTemp, Log, TEXT("Combat audio total: requests %d, culled %d, active %d/%d, pooled %d, preloaded sounds %d"),
+		Total.Requests, Total.DistanceCulled + Total.BudgetCulled, Total.ActiveVoices, MaxTotalVoices,
+		Total.PooledComponents, PreloadedSounds.Num());
+}
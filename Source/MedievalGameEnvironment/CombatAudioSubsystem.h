@@ -0,0 +1,153 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatAudioSubsystem.generated.h"
+
+class USoundBase;
+class UAudioComponent;
+
+UENUM(BlueprintType)
+enum class ECombatSoundCategory : uint8
+{
+	ECSC_WeaponFire UMETA(DisplayName = "WeaponFire"),
+	ECSC_Impact UMETA(DisplayName = "Impact"),
+	ECSC_Melee UMETA(DisplayName = "Melee"),
+	ECSC_Interface UMETA(DisplayName = "Interface"),
+
+	ECSC_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+//voice budget of one sound category
+USTRUCT(BlueprintType)
+struct FCombatSoundCategorySettings
+{
+	GENERATED_BODY()
+
+	//voices of the category that can play at the same time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxVoices = 8;
+
+	//positional requests further than this from the listener are dropped, 0 never culls
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxDistance = 0.f;
+
+	//when the total budget is used up, higher priority categories take voices from lower ones
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Priority = 0;
+};
+
+//request and voice counters for one category (or for all of them)
+USTRUCT(BlueprintType)
+struct FCombatSoundStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Requests = 0;
+
+	//requests dropped because they were too far from the listener
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 DistanceCulled = 0;
+
+	//requests dropped because no voice could be freed for them
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 BudgetCulled = 0;
+
+	//playing voices that were cut off for a more important request
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Stolen = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 ActiveVoices = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 PeakVoices = 0;
+
+	//audio components created for the category
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 PooledComponents = 0;
+};
+
+//pooled audio components of one category
+USTRUCT()
+struct FCombatSoundPool
+{
+	GENERATED_BODY()
+
+	//idle components ready to play
+	UPROPERTY()
+	TArray<UAudioComponent*> Free;
+
+	//playing components, oldest first
+	UPROPERTY()
+	TArray<UAudioComponent*> Active;
+
+	UPROPERTY()
+	FCombatSoundStats Stats;
+};
+
+/**
+ * Plays combat one-shots through pooled audio components with a voice budget per category.
+ * Requests beyond the listener's range of the category are dropped, and a full category replaces its
+ * farthest (or oldest) voice only when the new request is closer.
+ */
+UCLASS(Config = Game)
+class MEDIEVALGAMEENVIRONMENT_API UCombatAudioSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UCombatAudioSubsystem();
+
+	virtual void Deinitialize() override;
+
+	//primes the sound's audio data and creates idle components for its category up to PrewarmCount
+	void PreloadSound(USoundBase* Sound, ECombatSoundCategory Category);
+
+	//drop-ins for UGameplayStatics::PlaySound2D and PlaySoundAtLocation, return false when the request was culled
+	bool PlaySound2D(USoundBase* Sound, ECombatSoundCategory Category);
+	bool PlaySoundAtLocation(USoundBase* Sound, const FVector& Location, ECombatSoundCategory Category);
+
+	FCombatSoundStats GetCategoryStats(ECombatSoundCategory Category) const;
+	FCombatSoundStats GetTotalStats() const;
+
+	//writes per-category stats to the log
+	void DumpStats() const;
+
+private:
+	bool PlaySound(USoundBase* Sound, const FVector* Location, ECombatSoundCategory Category);
+
+	//frees a voice for a request of the category, false if every candidate is more important than the request
+	bool MakeRoom(FCombatSoundPool& Pool, ECombatSoundCategory Category, float RequestDistanceSquared);
+
+	UAudioComponent* AcquireComponent(FCombatSoundPool& Pool);
+	UAudioComponent* CreatePooledComponent();
+	void StopVoice(FCombatSoundPool& Pool, int32 ActiveIndex);
+
+	bool GetListenerLocation(FVector& OutLocation) const;
+	float GetDistanceSquaredToListener(const UAudioComponent* Component) const;
+
+	//called by pooled components when their sound has finished playing
+	void OnPooledAudioFinished(UAudioComponent* Component);
+
+	UPROPERTY(Transient)
+	FCombatSoundPool Pools[static_cast<int32>(ECombatSoundCategory::ECSC_MAX)];
+
+	UPROPERTY(Config)
+	FCombatSoundCategorySettings CategorySettings[static_cast<int32>(ECombatSoundCategory::ECSC_MAX)];
+
+	//voices of all categories together
+	UPROPERTY(Config)
+	int32 MaxTotalVoices;
+
+	//idle components created per category when its first sound is preloaded
+	UPROPERTY(Config)
+	int32 PrewarmCount;
+
+	//sounds already primed
+	UPROPERTY(Transient)
+	TSet<USoundBase*> PreloadedSounds;
+};
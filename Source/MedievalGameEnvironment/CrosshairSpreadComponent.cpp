@@ -0,0 +1,132 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "CrosshairSpreadComponent.h"
+#include "Camera/CameraComponent.h"
+
+UCrosshairSpreadComponent::UCrosshairSpreadComponent() :
+	//camera field of view values
+	CameraDefaultFOV(0.f), CameraZoomedFOV(35.f), CameraCurrentFOV(0.f), ZoomInterpSpeed(20.f),
+	//crosshair spread factors
+	CrosshairSpreadMultiplier(0.f),
+	CrosshairVelocityFactor(0.f),
+	CrosshairInAirFactor(0.f),
+	CrosshairAimFactor(0.f),
+	CrosshairShootingFactor(0.f),
+	//sleep thresholds
+	ConvergeTolerance(0.001f),
+	SpeedTolerance(1.f),
+	//inputs
+	bAimingInput(false), bFiringInput(false), bInAirInput(false), GroundSpeedInput(0.f)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+}
+
+void UCrosshairSpreadComponent::SetCamera(UCameraComponent* Camera)
+{
+	ZoomCamera = Camera;
+	if (ZoomCamera)
+	{
+		CameraDefaultFOV = ZoomCamera->FieldOfView;
+		CameraCurrentFOV = CameraDefaultFOV;
+	}
+	Wake();
+}
+
+void UCrosshairSpreadComponent::SetAiming(bool bAiming)
+{
+	if (bAimingInput == bAiming) return;
+
+	bAimingInput = bAiming;
+	Wake();
+}
+
+void UCrosshairSpreadComponent::SetFiring(bool bFiring)
+{
+	if (bFiringInput == bFiring) return;
+
+	bFiringInput = bFiring;
+	Wake();
+}
+
+void UCrosshairSpreadComponent::SetInAir(bool bInAir)
+{
+	if (bInAirInput == bInAir) return;
+
+	bInAirInput = bInAir;
+	Wake();
+}
+
+void UCrosshairSpreadComponent::SetGroundSpeed(float Speed)
+{
+	if (FMath::IsNearlyEqual(GroundSpeedInput, Speed, SpeedTolerance)) return;
+
+	GroundSpeedInput = Speed;
+	Wake();
+}
+
+void UCrosshairSpreadComponent::Wake()
+{
+	if (!IsComponentTickEnabled())
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+bool UCrosshairSpreadComponent::InterpFactor(float& Current, float Target, float DeltaTime, float InterpSpeed) const
+{
+	Current = FMath::FInterpTo(Current, Target, DeltaTime, InterpSpeed);
+	if (FMath::IsNearlyEqual(Current, Target, ConvergeTolerance))
+	{
+		Current = Target;
+		return true;
+	}
+	return false;
+}
+
+void UCrosshairSpreadComponent::TickComponent(float DeltaTime, ELevelTick TickType, 
+	FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	//interpolate to zoomed FOV when aiming, back to default FOV otherwise
+	const float PreviousFOV{ CameraCurrentFOV };
+	bool bConverged = InterpFactor(CameraCurrentFOV, bAimingInput ? CameraZoomedFOV : CameraDefaultFOV, DeltaTime, 
+		ZoomInterpSpeed);
+	if (ZoomCamera && CameraCurrentFOV != PreviousFOV)
+	{
+		ZoomCamera->SetFieldOfView(CameraCurrentFOV);
+	}
+
+	//calculate crosshair velocity factor
+	const FVector2D WalkSpeedRange{ 0.f, 600.f };
+	const FVector2D VelocityMultiplierRange{ 0.f, 1.f };
+	CrosshairVelocityFactor = FMath::GetMappedRangeValueClamped(WalkSpeedRange, VelocityMultiplierRange, GroundSpeedInput);
+
+	//spread the crosshair slowly while in air, shrink it rapidly while on the ground
+	bConverged &= bInAirInput ? InterpFactor(CrosshairInAirFactor, 2.25f, DeltaTime, 2.25f)
+		: InterpFactor(CrosshairInAirFactor, 0.f, DeltaTime, 30.f);
+
+	//shrink crosshair a small amount very quickly when aiming, spread to normal very quickly otherwise
+	//interpolates from the in air factor like the original crosshair did, so it is derived each tick and has no
+	//state of its own to converge, the multiplier freezes at its last value once the other factors settle
+	CrosshairAimFactor = FMath::FInterpTo(CrosshairInAirFactor, bAimingInput ? 0.6f : 0.f, DeltaTime, 30.f);
+
+	//true 0.05seconds after firing
+	bConverged &= InterpFactor(CrosshairShootingFactor, bFiringInput ? 0.3f : 0.f, DeltaTime, 60.f);
+
+	const float PreviousSpread{ CrosshairSpreadMultiplier };
+	CrosshairSpreadMultiplier = 0.5f + CrosshairVelocityFactor + CrosshairInAirFactor - CrosshairAimFactor
+		+ CrosshairShootingFactor;
+	if (CrosshairSpreadMultiplier != PreviousSpread)
+	{
+		OnCrosshairSpreadChanged.Broadcast(CrosshairSpreadMultiplier);
+	}
+
+	if (bConverged)
+	{
+		//nothing left to interpolate until an input changes
+		SetComponentTickEnabled(false);
+	}
+}
@@ -0,0 +1,97 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CrosshairSpreadComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FCrosshairSpreadChangedDelegate, float, SpreadMultiplier);
+
+/**
+ * Interpolates the aiming camera zoom and the crosshair spread.
+ * Only ticks after one of its inputs changed and goes back to sleep once everything has converged.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class MEDIEVALGAMEENVIRONMENT_API UCrosshairSpreadComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCrosshairSpreadComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	//camera whose field of view is zoomed; its current field of view becomes the default
+	void SetCamera(class UCameraComponent* Camera);
+
+	//inputs, each one wakes the component up when it changes
+	void SetAiming(bool bAiming);
+	void SetFiring(bool bFiring);
+	void SetInAir(bool bInAir);
+	void SetGroundSpeed(float Speed);
+
+	//starts ticking until every factor has converged again
+	void Wake();
+
+	//broadcast whenever the spread multiplier changes
+	UPROPERTY(BlueprintAssignable, Category = Delegates)
+	FCrosshairSpreadChangedDelegate OnCrosshairSpreadChanged;
+
+	FORCEINLINE float GetSpreadMultiplier() const { return CrosshairSpreadMultiplier; }
+	FORCEINLINE float GetCurrentFOV() const { return CameraCurrentFOV; }
+
+private:
+	//moves Current towards Target, snapping once within ConvergeTolerance; returns true when converged
+	bool InterpFactor(float& Current, float Target, float DeltaTime, float InterpSpeed) const;
+
+	UPROPERTY()
+	class UCameraComponent* ZoomCamera;
+
+	//default camera field of view value
+	float CameraDefaultFOV;
+
+	//field of view value when zoomed in
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CameraZoomedFOV;
+
+	//current field of view this frame
+	float CameraCurrentFOV;
+
+	//interp speed for zooming when aiming
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float ZoomInterpSpeed;
+
+	//determines the spread of the crosshair
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CrosshairSpreadMultiplier;
+
+	//velocity component of crosshair spread
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CrosshairVelocityFactor;
+
+	//in air component of the crosshair spread
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CrosshairInAirFactor;
+
+	//aim component of the crosshair spread
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CrosshairAimFactor;
+
+	//shooting component of the crosshair spread
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float CrosshairShootingFactor;
+
+	//factors closer than this to their target are snapped and count as converged
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float ConvergeTolerance;
+
+	//ground speed changes below this don't wake the component
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	float SpeedTolerance;
+
+	bool bAimingInput;
+	bool bFiringInput;
+	bool bInAirInput;
+	float GroundSpeedInput;
+};
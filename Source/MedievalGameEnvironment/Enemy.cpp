@@ -8,45 +8,76 @@
 #include "Kismet/KismetMathLibrary.h"
 #include "DrawDebugHelpers.h"
 #include "EnemyController.h"
-#include "BehaviorTree/BlackboardComponent.h"
 #include "Components/SphereComponent.h"
 #include "Main.h"
 #include "Components/CapsuleComponent.h"
-#include "Components/BoxComponent.h"
 #include "Main.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "Components/WidgetComponent.h"
+#include "FXPoolSubsystem.h"
+#include "CombatAudioSubsystem.h"
+#include "SignificanceSubsystem.h"
+#include "EnemySpawner.h"
+#include "MeleeTraceComponent.h"
+#include "EnemyPerceptionSubsystem.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "BrainComponent.h"
+
+//names of the melee trace shapes switched by the anim notifies
+static const FName LeftWeaponShape(TEXT("LeftWeapon"));
+static const FName RightWeaponShape(TEXT("RightWeapon"));
+static const FName LeftFootShape(TEXT("LeftFoot"));
+static const FName RightFootShape(TEXT("RightFoot"));
 
 // Sets default values
 AEnemy::AEnemy(): Health(100.f), MaxHealth(100.f), HealthbarDisplayTime(4.f), bCanHitReact(true), HitReactTimeMin(.25f),
-HitReactTimeMax(.75f), bStunned(false), StunChance(0.5f), Attack01(TEXT("Attack01")), AttackGaurdBreakA(TEXT("AttackGaurdBreakA")),
+HitReactTimeMax(.75f), bStunned(false), StunChance(0.5f), bAgro(false), LODTier(EEnemyLODTier::EELT_Full), Attack01(TEXT("Attack01")), AttackGaurdBreakA(TEXT("AttackGaurdBreakA")),
 AttackGuardBreakC(TEXT("AttackGuardBreakC")), AttackMeleeA(TEXT("AttackMeleeA")), AttackMeleeB(TEXT("AttackMeleeB")), 
 AttackMeleeC(TEXT("AttackMeleeC")), AttackMeleeCDash(TEXT("AttackMeleeCDash")), BaseDamage(20.f), 
 LeftWeaponSocket(TEXT("FX_Trail_L_01")), RightWeaponSocket(TEXT("FX_Trail_R01")), bDying(false), DeathTime(4.f)
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	//nothing to do per frame, component ticks are throttled by USignificanceSubsystem
+	PrimaryActorTick.bCanEverTick = false;
 
 	//create agrosphere
 	AgroSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AgroSphere"));
 	AgroSphere->SetupAttachment(GetRootComponent());
+	AgroSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AgroSphere->SetGenerateOverlapEvents(false);
 
 	//create combat range sphere
 	CombatRangeSphere = CreateAbstractDefaultSubobject<USphereComponent>(TEXT("CombatRange"));
 	CombatRangeSphere->SetupAttachment(GetRootComponent());
-
-	//construct left and right collision boxes
-	LeftWeaponCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("Left Weapon Box"));
-	LeftWeaponCollision->SetupAttachment(GetMesh(), FName("LeftWeaponBone"));
-
-	RightWeaponCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("Right Weapon Box"));
-	RightWeaponCollision->SetupAttachment(GetMesh(), FName("RightWeaponBone"));
-
-	LeftFootCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("Left Foot Box"));
-	LeftFootCollision->SetupAttachment(GetMesh(), FName("LeftFoot"));
-
-	RightFootCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("Right Foot Box"));
-	RightFootCollision->SetupAttachment(GetMesh(), FName("RightFoot"));
+	CombatRangeSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CombatRangeSphere->SetGenerateOverlapEvents(false);
+
+	//weapons are swept from the weapon bone to the trail socket at its tip, feet as a single sphere
+	MeleeTrace = CreateDefaultSubobject<UMeleeTraceComponent>(TEXT("MeleeTrace"));
+	MeleeTrace->SetMesh(GetMesh());
+
+	FMeleeTraceShape LeftWeapon;
+	LeftWeapon.Name = LeftWeaponShape;
+	LeftWeapon.StartSocket = FName("LeftWeaponBone");
+	LeftWeapon.EndSocket = LeftWeaponSocket;
+	MeleeTrace->AddShape(LeftWeapon);
+
+	FMeleeTraceShape RightWeapon;
+	RightWeapon.Name = RightWeaponShape;
+	RightWeapon.StartSocket = FName("RightWeaponBone");
+	RightWeapon.EndSocket = RightWeaponSocket;
+	MeleeTrace->AddShape(RightWeapon);
+
+	FMeleeTraceShape LeftFoot;
+	LeftFoot.Name = LeftFootShape;
+	LeftFoot.StartSocket = FName("LeftFoot");
+	LeftFoot.Radius = 15.f;
+	MeleeTrace->AddShape(LeftFoot);
+
+	FMeleeTraceShape RightFoot;
+	RightFoot.Name = RightFootShape;
+	RightFoot.StartSocket = FName("RightFoot");
+	RightFoot.Radius = 15.f;
+	MeleeTrace->AddShape(RightFoot);
 
 	DeathWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("DeathWidget"));
 	DeathWidget->SetupAttachment(GetRootComponent());
@@ -61,36 +92,7 @@ void AEnemy::BeginPlay()
 	//hide death widget
 	DeathWidget->SetVisibility(false);
 
-	AgroSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::AgroSphereOverlap);
-	CombatRangeSphere->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::CombatRangeOverlap);
-	CombatRangeSphere->OnComponentEndOverlap.AddDynamic(this, &AEnemy::ComabtRangeEndOverlap);
-
-	//bind functions to overlap events for weapon boxes
-	LeftWeaponCollision->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::OnLeftWeaponOverlap);
-	RightWeaponCollision->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::OnRightWeaponOverlap);
-	LeftFootCollision->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::OnLeftFootOverlap);
-	RightFootCollision->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::OnRightFootOverlap);
-
-	//set collsision presets for weapon boxes
-	LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	LeftWeaponCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-	LeftWeaponCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	LeftWeaponCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
-
-	RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	RightWeaponCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-	RightWeaponCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	RightWeaponCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
-
-	LeftFootCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	LeftFootCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-	LeftFootCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	LeftFootCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
-
-	RightFootCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	RightFootCollision->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
-	RightFootCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-	RightFootCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+	MeleeTrace->OnMeleeHit.AddDynamic(this, &AEnemy::OnMeleeHit);
 
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
 	GetMesh()->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
@@ -98,28 +100,57 @@ void AEnemy::BeginPlay()
 
 
 
+	BuildHitZoneTable();
+
 	//get the AI controller
 	EnemyController = Cast<AEnemyController>(GetController());
 
-	const FVector WorldPatrolPoint = UKismetMathLibrary::TransformLocation(GetActorTransform(), PatrolPoint);
-
-	const FVector WorldPatrolPoint2 = UKismetMathLibrary::TransformLocation(GetActorTransform(), PatrolPoint2);
-
-	/*DrawDebugSphere(GetWorld(), WorldPatrolPoint, 25.f, 12, FColor::Yellow, true);
-
-	DrawDebugSphere(GetWorld(), WorldPatrolPoint2, 25.f, 12, FColor::Yellow, true);*/
-
+	UpdatePatrolPoints();
 	if (EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsVector(TEXT("PatrolPoint"), WorldPatrolPoint);
+		EnemyController->RunBehaviorTree(BehaviorTree);
+	}
 
-		EnemyController->GetBlackboardComponent()->SetValueAsVector(TEXT("PatrolPoint2"), WorldPatrolPoint2);
+	//shared pools for the hit and death effects
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (FXPool)
+	{
+		FXPool->PrewarmTemplate(ImpactParticles);
+		FXPool->PrewarmTemplate(TeleportParticles);
+	}
 
-		EnemyController->RunBehaviorTree(BehaviorTree);
+	UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+	if (CombatAudio)
+	{
+		CombatAudio->PreloadSound(ImpactSound, ECombatSoundCategory::ECSC_Impact);
+		CombatAudio->PreloadSound(TeleportSound, ECombatSoundCategory::ECSC_Impact);
+	}
+
+	if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>())
+	{
+		Significance->RegisterActor(this);
+	}
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->RegisterEnemy(this);
 	}
 	
 }
 
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>())
+	{
+		Significance->UnregisterActor(this);
+	}
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->UnregisterEnemy(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void AEnemy::ShowHealthBar_Implementation()
 {
 	GetWorldTimerManager().ClearTimer(HealthBarTimer);
@@ -132,6 +163,7 @@ void AEnemy::Die()
 	if (bDying) return;
 
 	bDying = true;
+	StopMeleeAttack();
 	HideHealthBar();
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 	if (AnimInstance && DeathMontage)
@@ -140,7 +172,7 @@ void AEnemy::Die()
 	}
 	if (EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsBool(FName("Dead"), true);
+		EnemyController->SetDead(true);
 		EnemyController->StopMovement();
 	}
 }
@@ -149,6 +181,9 @@ void AEnemy::PlayHitMontage(FName Section, float PlayRate)
 {
 	if (bCanHitReact)
 	{
+		//the hit reaction interrupts the attack montage before its deactivate notifies
+		StopMeleeAttack();
+
 		UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
 		if (AnimInstance)
 		{
@@ -167,16 +202,16 @@ void AEnemy::ResetHitReactTimer()
 	bCanHitReact = true;
 }
 
-void AEnemy::AgroSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, 
-	int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::OnPlayerEnteredAgroRange(AMain* Character)
 {
-	if (OtherActor == nullptr) return;
+	if (Character == nullptr) return;
 
-	auto Character = Cast<AMain>(OtherActor);
-	if (Character)
+	//set the value of target blackboard key
+	bAgro = true;
+	SetLODTier(EEnemyLODTier::EELT_Full);
+	if (EnemyController)
 	{
-		//set the value of target blackboard key
-		EnemyController->GetBlackboardComponent()->SetValueAsObject(TEXT("Target"), Character);
+		EnemyController->SetTarget(Character);
 	}
 }
 
@@ -186,40 +221,65 @@ void AEnemy::SetStunned(bool Stunned)
 
 	if (EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsBool(TEXT("Stunned"), Stunned);
+		EnemyController->SetStunned(Stunned);
 	}
 }
 
-void AEnemy::CombatRangeOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, 
-	int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::SetPlayerInAttackRange(bool bInRange)
 {
-	if (OtherActor == nullptr) return;
-	auto MainCharacter = Cast<AMain>(OtherActor);
-
-	if (MainCharacter)
+	bInAttackRange = bInRange;
+	if (EnemyController)
 	{
-		bInAttackRange = true;
-		if (EnemyController)
-		{
-			EnemyController->GetBlackboardComponent()->SetValueAsBool(TEXT("InAttackRange"), true);
-		}
+		EnemyController->SetInAttackRange(bInRange);
 	}
 }
 
-void AEnemy::ComabtRangeEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, 
-	int32 OtherBodyIndex)
+void AEnemy::SetLODTier(EEnemyLODTier NewTier)
 {
-	if (OtherActor == nullptr) return;
-	auto MainCharacter = Cast<AMain>(OtherActor);
+	if (NewTier == LODTier) return;
+
+	LODTier = NewTier;
+	if (EnemyController)
+	{
+		EnemyController->SetLODTier(NewTier);
+	}
 
-	if (MainCharacter)
+	//nav walking follows the navmesh instead of sweeping the capsule against the floor
+	UCharacterMovementComponent* Movement = GetCharacterMovement();
+	if (NewTier == EEnemyLODTier::EELT_Full)
 	{
-		bInAttackRange = false;
-		if (EnemyController)
+		if (Movement->MovementMode == MOVE_NavWalking)
 		{
-			EnemyController->GetBlackboardComponent()->SetValueAsBool(TEXT("InAttackRange"), false);
+			Movement->SetMovementMode(MOVE_Walking);
 		}
 	}
+	else if (Movement->MovementMode == MOVE_Walking)
+	{
+		Movement->SetMovementMode(MOVE_NavWalking);
+	}
+
+	//the death timer keeps running so corpses still go back to the pool
+	FTimerManager& TimerManager = GetWorldTimerManager();
+	if (NewTier == EEnemyLODTier::EELT_Minimal)
+	{
+		TimerManager.PauseTimer(HitReactTimer);
+		TimerManager.PauseTimer(HealthBarTimer);
+	}
+	else
+	{
+		TimerManager.UnPauseTimer(HitReactTimer);
+		TimerManager.UnPauseTimer(HealthBarTimer);
+	}
+}
+
+float AEnemy::GetAgroRadius() const
+{
+	return AgroSphere->GetScaledSphereRadius();
+}
+
+float AEnemy::GetAttackRadius() const
+{
+	return CombatRangeSphere->GetScaledSphereRadius();
 }
 
 void AEnemy::PlayAttackMontage(FName Section, float PlayRate)
@@ -231,6 +291,9 @@ void AEnemy::PlayAttackMontage(FName Section, float PlayRate)
 		AnimInstance->Montage_Play(AttackMontage);
 		AnimInstance->Montage_JumpToSection(Section, AttackMontage);
 	}
+
+	//every attack may hit the character once
+	MeleeTrace->BeginSwing();
 }
 
 FName AEnemy::GetAttackSectionName()
@@ -269,9 +332,10 @@ void AEnemy::DoDamage(AMain* Victim)
 {
 	if (Victim == nullptr) return;
 	UGameplayStatics::ApplyDamage(Victim, BaseDamage, EnemyController, this, UDamageType::StaticClass());
-	if (Victim->GetMeleeImpactSound())
+	UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+	if (Victim->GetMeleeImpactSound() && CombatAudio)
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, Victim->GetMeleeImpactSound(), GetActorLocation());
+		CombatAudio->PlaySoundAtLocation(Victim->GetMeleeImpactSound(), GetActorLocation(), ECombatSoundCategory::ECSC_Melee);
 	}
 }
 
@@ -281,9 +345,10 @@ void AEnemy::SpawnBlood(AMain* Victim, FName SocketName)
 	if (TipSocket)
 	{
 		const FTransform SocketTransform{ TipSocket->GetSocketTransform(GetMesh()) };
-		if (Victim->GetBloodParticles())
+		UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+		if (Victim->GetBloodParticles() && FXPool)
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Victim->GetBloodParticles(), SocketTransform);
+			FXPool->SpawnEmitter(Victim->GetBloodParticles(), SocketTransform);
 		}
 	}
 }
@@ -310,105 +375,302 @@ void AEnemy::FinishDeath()
 
 void AEnemy::DestroyEnemy()
 {
-	if (TeleportSound)
+	UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+	if (TeleportSound && CombatAudio)
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
+		CombatAudio->PlaySoundAtLocation(TeleportSound, GetActorLocation(), ECombatSoundCategory::ECSC_Impact);
 	}
-	if (TeleportParticles)
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (TeleportParticles && FXPool)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), TeleportParticles, GetActorLocation(), FRotator(0.f), true);
+		FXPool->SpawnEmitterAtLocation(TeleportParticles, GetActorLocation());
+	}
+
+	//spawned enemies go back to their spawner's pool
+	if (Spawner.IsValid())
+	{
+		Spawner->ReleaseEnemy(this);
+		return;
 	}
 
 	Destroy();
 }
 
-void AEnemy::OnLeftWeaponOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::UpdatePatrolPoints()
 {
-	auto Character = Cast<AMain>(OtherActor);
-	if(Character)
-	{ 
-		DoDamage(Character);
-		SpawnBlood(Character, LeftWeaponSocket);
-		StunCharacter(Character);
+	const FVector WorldPatrolPoint = UKismetMathLibrary::TransformLocation(GetActorTransform(), PatrolPoint);
+
+	const FVector WorldPatrolPoint2 = UKismetMathLibrary::TransformLocation(GetActorTransform(), PatrolPoint2);
+
+	/*DrawDebugSphere(GetWorld(), WorldPatrolPoint, 25.f, 12, FColor::Yellow, true);
+
+	DrawDebugSphere(GetWorld(), WorldPatrolPoint2, 25.f, 12, FColor::Yellow, true);*/
+
+	if (EnemyController)
+	{
+		EnemyController->SetPatrolPoints(WorldPatrolPoint, WorldPatrolPoint2);
 	}
 }
 
-void AEnemy::OnRightWeaponOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::ParkInPool()
 {
-	auto Character = Cast<AMain>(OtherActor);
-	if (Character)
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+
+	if (EnemyController)
 	{
-		DoDamage(Character);
-		SpawnBlood(Character, LeftWeaponSocket);
-		StunCharacter(Character);
+		EnemyController->StopMovement();
+		if (UBrainComponent* Brain = EnemyController->GetBrainComponent())
+		{
+			Brain->StopLogic(TEXT("Pooled"));
+		}
 	}
+
+	if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>())
+	{
+		Significance->UnregisterActor(this);
+	}
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->UnregisterEnemy(this);
+	}
+
+	StopMeleeAttack();
+
+	HideHealthBar();
+	DeathWidget->SetVisibility(false);
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+	GetMesh()->bPauseAnims = true;
+	GetMesh()->SetComponentTickEnabled(false);
 }
 
-void AEnemy::OnLeftFootOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::ResetForReuse(const FTransform& SpawnTransform)
 {
-	auto Character = Cast<AMain>(OtherActor);
-	if (Character)
+	GetWorldTimerManager().ClearAllTimersForObject(this);
+
+	Health = MaxHealth;
+	bDying = false;
+	bStunned = false;
+	bCanHitReact = true;
+	bInAttackRange = false;
+	bAgro = false;
+
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->SetDefaultMovementMode();
+	GetMesh()->SetComponentTickEnabled(true);
+	GetMesh()->bPauseAnims = false;
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->Montage_Stop(0.f);
+	}
+
+	//controllers can be lost if the pooled enemy was unpossessed
+	if (GetController() == nullptr)
 	{
-		DoDamage(Character);
-		StunCharacter(Character);
+		SpawnDefaultController();
+	}
+	EnemyController = Cast<AEnemyController>(GetController());
+	LODTier = EEnemyLODTier::EELT_Full;
+	if (EnemyController)
+	{
+		EnemyController->SetLODTier(EEnemyLODTier::EELT_Full);
+		EnemyController->SetTarget(nullptr);
+		EnemyController->SetInAttackRange(false);
+		EnemyController->SetStunned(false);
+		EnemyController->SetDead(false);
+		EnemyController->SetCharacterDead(false);
+		UpdatePatrolPoints();
+
+		UBrainComponent* Brain = EnemyController->GetBrainComponent();
+		if (Brain)
+		{
+			Brain->RestartLogic();
+		}
+		else
+		{
+			EnemyController->RunBehaviorTree(BehaviorTree);
+		}
+	}
+
+	if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>())
+	{
+		Significance->RegisterActor(this);
+	}
+	if (UEnemyPerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UEnemyPerceptionSubsystem>())
+	{
+		Perception->RegisterEnemy(this);
 	}
 }
 
-void AEnemy::OnRightFootOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AEnemy::BuildHitZoneTable()
 {
-	auto Character = Cast<AMain>(OtherActor);
-	if (Character)
+	BoneHitZones.Reset();
+	BoneDamageMultipliers.Reset();
+	BodyHitZones.Reset();
+	BodyDamageMultipliers.Reset();
+
+	USkeletalMeshComponent* MeshComponent{ GetMesh() };
+	if (MeshComponent == nullptr || MeshComponent->SkeletalMesh == nullptr) return;
+
+	const FReferenceSkeleton& RefSkeleton{ MeshComponent->SkeletalMesh->GetRefSkeleton() };
+	const int32 NumBones{ RefSkeleton.GetNum() };
+	BoneHitZones.Init(EHitZone::EHZ_Torso, NumBones);
+	BoneDamageMultipliers.Init(1.f, NumBones);
+
+	//bones that have their own entry, and bones whose entry carries over to their children
+	TArray<bool> ExplicitBones;
+	TArray<bool> InheritingBones;
+	ExplicitBones.Init(false, NumBones);
+	InheritingBones.Init(false, NumBones);
+
+	auto AssignBone = [&](FName BoneName, EHitZone HitZone, float DamageMultiplier, bool bIncludeChildBones)
 	{
-		DoDamage(Character);
-		StunCharacter(Character);
+		const int32 BoneIndex{ RefSkeleton.FindBoneIndex(BoneName) };
+		if (BoneIndex == INDEX_NONE) return;
+
+		BoneHitZones[BoneIndex] = HitZone;
+		BoneDamageMultipliers[BoneIndex] = DamageMultiplier;
+		ExplicitBones[BoneIndex] = true;
+		InheritingBones[BoneIndex] = bIncludeChildBones;
+	};
+
+	//the head bone is a head shot unless the table says otherwise
+	AssignBone(HeadBone, EHitZone::EHZ_Head, 1.f, true);
+
+	if (HitZoneDataTable)
+	{
+		TArray<FHitZoneTable*> Rows;
+		HitZoneDataTable->GetAllRows<FHitZoneTable>(TEXT("BuildHitZoneTable"), Rows);
+		for (const FHitZoneTable* Row : Rows)
+		{
+			AssignBone(Row->BoneName, Row->HitZone, Row->DamageMultiplier, Row->bIncludeChildBones);
+		}
 	}
+
+	//parents always come before their children in the reference skeleton
+	for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+	{
+		if (ExplicitBones[BoneIndex]) continue;
+
+		const int32 ParentIndex{ RefSkeleton.GetParentIndex(BoneIndex) };
+		if (ParentIndex != INDEX_NONE && InheritingBones[ParentIndex])
+		{
+			BoneHitZones[BoneIndex] = BoneHitZones[ParentIndex];
+			BoneDamageMultipliers[BoneIndex] = BoneDamageMultipliers[ParentIndex];
+			InheritingBones[BoneIndex] = true;
+		}
+	}
+
+	//physics bodies map straight onto the bone they simulate
+	const int32 NumBodies{ MeshComponent->Bodies.Num() };
+	BodyHitZones.Init(EHitZone::EHZ_Torso, NumBodies);
+	BodyDamageMultipliers.Init(1.f, NumBodies);
+	for (int32 BodyIndex = 0; BodyIndex < NumBodies; BodyIndex++)
+	{
+		const FBodyInstance* Body{ MeshComponent->Bodies[BodyIndex] };
+		if (Body && BoneHitZones.IsValidIndex(Body->InstanceBoneIndex))
+		{
+			BodyHitZones[BodyIndex] = BoneHitZones[Body->InstanceBoneIndex];
+			BodyDamageMultipliers[BodyIndex] = BoneDamageMultipliers[Body->InstanceBoneIndex];
+		}
+	}
+}
+
+EHitZone AEnemy::GetHitZone(const FHitResult& HitResult, float& OutDamageMultiplier) const
+{
+	//body indices and bone names only mean something on the mesh the tables were built from
+	if (HitResult.GetComponent() != GetMesh())
+	{
+		OutDamageMultiplier = 1.f;
+		return EHitZone::EHZ_Torso;
+	}
+
+	const int32 BodyIndex{ HitResult.Item };
+	if (BodyHitZones.IsValidIndex(BodyIndex))
+	{
+		OutDamageMultiplier = BodyDamageMultipliers[BodyIndex];
+		return BodyHitZones[BodyIndex];
+	}
+
+	//no body index (e.g. a hit on a simple collision shape), fall back to the bone
+	const int32 BoneIndex{ GetMesh()->GetBoneIndex(HitResult.BoneName) };
+	if (BoneHitZones.IsValidIndex(BoneIndex))
+	{
+		OutDamageMultiplier = BoneDamageMultipliers[BoneIndex];
+		return BoneHitZones[BoneIndex];
+	}
+
+	OutDamageMultiplier = 1.f;
+	return EHitZone::EHZ_Torso;
+}
+
+void AEnemy::OnMeleeHit(const FHitResult& HitResult, FName ShapeName)
+{
+	auto Character = Cast<AMain>(HitResult.GetActor());
+	if (Character == nullptr || !Character->CanBeDamaged()) return;
+
+	DoDamage(Character);
+	if (ShapeName == LeftWeaponShape)
+	{
+		SpawnBlood(Character, LeftWeaponSocket);
+	}
+	else if (ShapeName == RightWeaponShape)
+	{
+		SpawnBlood(Character, RightWeaponSocket);
+	}
+	StunCharacter(Character);
+}
+
+void AEnemy::StopMeleeAttack()
+{
+	MeleeTrace->StopTracing();
 }
 
 void AEnemy::ActivateLeftWeapon()
 {
-	LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	MeleeTrace->SetShapeActive(LeftWeaponShape, true);
 }
 
 void AEnemy::DeactivateLeftWeapon()
 {
-	LeftWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	MeleeTrace->SetShapeActive(LeftWeaponShape, false);
 }
 
 void AEnemy::ActivateRightWeapon()
 {
-	RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	MeleeTrace->SetShapeActive(RightWeaponShape, true);
 }
 
 void AEnemy::DeactivateRightWeapon()
 {
-	RightWeaponCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	MeleeTrace->SetShapeActive(RightWeaponShape, false);
 }
 
 void AEnemy::ActivateLeftFoot()
 {
-	LeftFootCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	MeleeTrace->SetShapeActive(LeftFootShape, true);
 }
 
 void AEnemy::DeactivateLeftFoot()
 {
-	LeftFootCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	MeleeTrace->SetShapeActive(LeftFootShape, false);
 }
 
 void AEnemy::ActivateRightFoot()
 {
-	RightFootCollision->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	MeleeTrace->SetShapeActive(RightFootShape, true);
 }
 
 void AEnemy::DeactivateRightFoot()
 {
-	RightFootCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-}
-
-// Called every frame
-void AEnemy::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
+	MeleeTrace->SetShapeActive(RightFootShape, false);
 }
 
 // Called to bind functionality to input
@@ -418,15 +680,17 @@ void AEnemy::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 
 }
 
-void AEnemy::WhipHit_Implementation(FHitResult HitResult)
+void AEnemy::WhipHit_Implementation(const FHitResult& HitResult)
 {
-	if (ImpactSound)
+	UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+	if (ImpactSound && CombatAudio)
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
+		CombatAudio->PlaySoundAtLocation(ImpactSound, GetActorLocation(), ECombatSoundCategory::ECSC_Impact);
 	}
-	if (ImpactParticles)
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (ImpactParticles && FXPool)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, HitResult.Location, FRotator(0.f), true);
+		FXPool->SpawnEmitterAtLocation(ImpactParticles, HitResult.Location);
 	}
 
 	if (bDying) return;
@@ -446,9 +710,11 @@ void AEnemy::WhipHit_Implementation(FHitResult HitResult)
 float AEnemy::TakeDamage(float Damageamount, FDamageEvent const& DamageEvent, AController* EventIntigator, AActor* DamageCauser)
 {
 	//set the target blackboard key to agro the character
+	bAgro = true;
+	SetLODTier(EEnemyLODTier::EELT_Full);
 	if(EnemyController)
 	{
-		EnemyController->GetBlackboardComponent()->SetValueAsObject(FName("Target"), DamageCauser);
+		EnemyController->SetTarget(DamageCauser);
 	}
 
 	if (Health - Damageamount <= 0.f)
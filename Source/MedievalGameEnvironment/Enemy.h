@@ -5,8 +5,41 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "WhipHitInterface.h"
+#include "Engine/DataTable.h"
+#include "EnemyLODTier.h"
 #include "Enemy.generated.h"
 
+UENUM(BlueprintType)
+enum class EHitZone : uint8
+{
+	EHZ_Head UMETA(DisplayName = "Head"),
+	EHZ_Torso UMETA(DisplayName = "Torso"),
+	EHZ_Limb UMETA(DisplayName = "Limb"),
+
+	EHZ_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+USTRUCT(BlueprintType)
+struct FHitZoneTable : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	//bone this row applies to
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName BoneName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EHitZone HitZone = EHitZone::EHZ_Torso;
+
+	//scales the whip damage for hits on this bone
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float DamageMultiplier = 1.f;
+
+	//child bones without a row of their own use this row too
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bIncludeChildBones = true;
+};
+
 UCLASS()
 class MEDIEVALGAMEENVIRONMENT_API AEnemy : public ACharacter, public IWhipHitInterface
 {
@@ -20,6 +53,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UFUNCTION(BlueprintNativeEvent)
 	void ShowHealthBar();
 	void ShowHealthBar_Implementation();
@@ -33,44 +68,14 @@ protected:
 
 	void ResetHitReactTimer();
 
-	//called when something overlaps the agrosphere
-	UFUNCTION()
-	void AgroSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-
 	UFUNCTION(BlueprintCallable)
 	void SetStunned(bool Stunned);
 
+	//first hit of an actor by the weapons or feet during the current attack
 	UFUNCTION()
-	void CombatRangeOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-
-	UFUNCTION()
-	void ComabtRangeEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex);
-
-	UFUNCTION(BlueprintCallable)
-	void PlayAttackMontage(FName Section, float PlayRate);
-
-	UFUNCTION(BlueprintPure)
-	FName GetAttackSectionName();
-
-	UFUNCTION()
-	void OnLeftWeaponOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, 
-		int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-
-	UFUNCTION()
-	void OnRightWeaponOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-
-	void OnLeftFootOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-
-	UFUNCTION()
-	void OnRightFootOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	void OnMeleeHit(const FHitResult& HitResult, FName ShapeName);
 
-	//actvate/deactivate collisions for weapon and foot boxes
+	//actvate/deactivate hit detection for the weapons and feet, called from anim notifies
 	UFUNCTION(BlueprintCallable)
 	void ActivateLeftWeapon();
 	UFUNCTION(BlueprintCallable)
@@ -103,6 +108,12 @@ protected:
 	UFUNCTION()
 	void DestroyEnemy();
 
+	//resolves the hit zone and damage multiplier of every bone and physics body of the mesh
+	void BuildHitZoneTable();
+
+	//sends the patrol points, relative to the current transform, to the blackboard
+	void UpdatePatrolPoints();
+
 private:
 	//particles to spawn when hit by whip
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -122,7 +133,19 @@ private:
 
 	//name of the head bone
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	FString HeadBone;
+	FName HeadBone;
+
+	//per-bone hit zones and damage multipliers; bones without a row are torso hits, the head bone defaults to head
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	UDataTable* HitZoneDataTable;
+
+	//hit zone and damage multiplier per bone index
+	TArray<EHitZone> BoneHitZones;
+	TArray<float> BoneDamageMultipliers;
+
+	//hit zone and damage multiplier per physics body index (FHitResult::Item)
+	TArray<EHitZone> BodyHitZones;
+	TArray<float> BodyDamageMultipliers;
 
 	//time to display health bar once shot
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -160,7 +183,7 @@ private:
 
 	class AEnemyController* EnemyController;
 
-	//overlap sphere for when the enemy becomes hostile
+	//range in which the enemy becomes hostile, only the radius is used (see UEnemyPerceptionSubsystem)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	class USphereComponent* AgroSphere;
 
@@ -176,7 +199,15 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	bool bInAttackRange;
 
-	//sphere for attack range
+	//true once the enemy has a target, set by the agro sphere or by taking damage
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	bool bAgro;
+
+	//AI level of detail, set by USignificanceSubsystem from the enemy's significance bucket
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Behavior Tree", meta = (AllowPrivateAccess = "true"))
+	EEnemyLODTier LODTier;
+
+	//attack range, only the radius is used (see UEnemyPerceptionSubsystem)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	USphereComponent* CombatRangeSphere;
 
@@ -193,21 +224,9 @@ private:
 	FName AttackMeleeC;
 	FName AttackMeleeCDash;
 	
-	//collision volume for the left weapon
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class UBoxComponent* LeftWeaponCollision;
-
-	//collision volume for the right weapon
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class UBoxComponent* RightWeaponCollision;
-
-	//collision volume for the left foot
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class UBoxComponent* LeftFootCollision;
-
-	//collision volume for the right foot
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	class UBoxComponent* RightFootCollision;
+	//sweeps the weapons and feet during attacks, each victim is hit once per attack
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	class UMeleeTraceComponent* MeleeTrace;
 
 	//base damage for the enemy
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
@@ -227,6 +246,9 @@ private:
 
 	FTimerHandle DeathTimer;
 
+	//pool the enemy goes back to instead of being destroyed, null for enemies placed in the level
+	TWeakObjectPtr<class AEnemySpawner> Spawner;
+
 	//time after death until self destruct
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	float DeathTime;
@@ -243,19 +265,58 @@ private:
 	class UWidgetComponent* DeathWidget;
 
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
-	virtual void WhipHit_Implementation(FHitResult HitResult) override;
+	virtual void WhipHit_Implementation(const FHitResult& HitResult) override;
 
 	virtual float TakeDamage(float Damageamount, struct FDamageEvent const &DamageEvent, AController* EventIntigator, 
 		AActor* DamageCauser) override;
 
-	FORCEINLINE FString GetHeadBone() const { return HeadBone; }
+	FORCEINLINE FName GetHeadBone() const { return HeadBone; }
+
+	//hit zone for a hit on the given physics body (bone name is only used when the body index is unknown),
+	//hits on anything but the skeletal mesh (capsule, attached meshes) use the default zone
+	EHitZone GetHitZone(const FHitResult& HitResult, float& OutDamageMultiplier) const;
 
 	FORCEINLINE UBehaviorTree* GetBehaviorTree() const { return BehaviorTree; }
 	FORCEINLINE UWidgetComponent* GetDeathWidget() const { return DeathWidget; }
+
+	//called by UEnemyPerceptionSubsystem when the player comes within the agro sphere
+	void OnPlayerEnteredAgroRange(class AMain* Character);
+
+	//called by UEnemyPerceptionSubsystem when the player enters or leaves the combat range sphere
+	void SetPlayerInAttackRange(bool bInRange);
+
+	float GetAgroRadius() const;
+	float GetAttackRadius() const;
+
+	//fighting the player, used to keep the enemy at full update rate
+	FORCEINLINE bool IsInCombat() const { return (bAgro || bInAttackRange) && !bDying; }
+	FORCEINLINE bool IsDying() const { return bDying; }
+
+	FORCEINLINE EEnemyLODTier GetLODTier() const { return LODTier; }
+
+	//throttles the behavior tree, simplifies movement and pauses timers below full detail
+	void SetLODTier(EEnemyLODTier NewTier);
+
+	FORCEINLINE void SetSpawner(class AEnemySpawner* NewSpawner) { Spawner = NewSpawner; }
+
+	//hides the enemy and stops its behavior, movement and timers while it waits in a spawner pool
+	void ParkInPool();
+
+	//brings a pooled enemy back to full health with fresh combat, animation and blackboard state
+	void ResetForReuse(const FTransform& SpawnTransform);
+
+	//switches every weapon and foot off
+	void StopMeleeAttack();
+
+	UFUNCTION(BlueprintCallable)
+	void PlayAttackMontage(FName Section, float PlayRate);
+
+	UFUNCTION(BlueprintPure)
+	FName GetAttackSectionName();
+
+	FORCEINLINE UAnimMontage* GetAttackMontage() const { return AttackMontage; }
+	FORCEINLINE UMeleeTraceComponent* GetMeleeTrace() const { return MeleeTrace; }
 };
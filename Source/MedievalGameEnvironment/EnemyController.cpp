@@ -4,10 +4,17 @@
 #include "EnemyController.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BrainComponent.h"
 #include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Vector.h"
 #include "Enemy.h"
 
-AEnemyController::AEnemyController()
+AEnemyController::AEnemyController(): TargetKey(FBlackboard::InvalidKey), InAttackRangeKey(FBlackboard::InvalidKey), 
+	StunnedKey(FBlackboard::InvalidKey), DeadKey(FBlackboard::InvalidKey), CharacterDeadKey(FBlackboard::InvalidKey), 
+	PatrolPointKey(FBlackboard::InvalidKey), PatrolPoint2Key(FBlackboard::InvalidKey), ReducedBehaviorTickInterval(0.25f),
+	MinimalBehaviorTickInterval(1.f)
 {
 	BlackboardComponent = CreateDefaultSubobject<UBlackboardComponent>(TEXT("BlackboardComponent"));
 	check(BlackboardComponent);
@@ -28,8 +35,104 @@ void AEnemyController::OnPossess(APawn* InPawn)
 		if (Enemy->GetBehaviorTree())
 		{
 			BlackboardComponent->InitializeBlackboard(*(Enemy->GetBehaviorTree()->BlackboardAsset));
+
+			//resolve the keys once instead of looking them up by name on every write
+			TargetKey = ResolveKey(TEXT("Target"), UBlackboardKeyType_Object::StaticClass());
+			InAttackRangeKey = ResolveKey(TEXT("InAttackRange"), UBlackboardKeyType_Bool::StaticClass());
+			StunnedKey = ResolveKey(TEXT("Stunned"), UBlackboardKeyType_Bool::StaticClass());
+			DeadKey = ResolveKey(TEXT("Dead"), UBlackboardKeyType_Bool::StaticClass());
+			CharacterDeadKey = ResolveKey(TEXT("CharacterDead"), UBlackboardKeyType_Bool::StaticClass());
+			PatrolPointKey = ResolveKey(TEXT("PatrolPoint"), UBlackboardKeyType_Vector::StaticClass());
+			PatrolPoint2Key = ResolveKey(TEXT("PatrolPoint2"), UBlackboardKeyType_Vector::StaticClass());
 		}
 	}
 
 }
 
+FBlackboard::FKey AEnemyController::ResolveKey(FName KeyName, TSubclassOf<UBlackboardKeyType> KeyType) const
+{
+	const FBlackboard::FKey KeyID{ BlackboardComponent->GetKeyID(KeyName) };
+	if (KeyID == FBlackboard::InvalidKey)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s: blackboard %s has no key '%s'"), *GetName(),
+			*GetNameSafe(BlackboardComponent->GetBlackboardAsset()), *KeyName.ToString());
+		return FBlackboard::InvalidKey;
+	}
+
+	if (BlackboardComponent->GetKeyType(KeyID) != KeyType)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s: blackboard key '%s' of %s is a %s, expected %s"), *GetName(), *KeyName.ToString(),
+			*GetNameSafe(BlackboardComponent->GetBlackboardAsset()), *GetNameSafe(BlackboardComponent->GetKeyType(KeyID)),
+			*GetNameSafe(KeyType));
+		return FBlackboard::InvalidKey;
+	}
+
+	return KeyID;
+}
+
+void AEnemyController::SetTarget(AActor* Target)
+{
+	if (TargetKey == FBlackboard::InvalidKey) return;
+
+	BlackboardComponent->SetValue<UBlackboardKeyType_Object>(TargetKey, Target);
+}
+
+void AEnemyController::SetInAttackRange(bool bInAttackRange)
+{
+	if (InAttackRangeKey == FBlackboard::InvalidKey) return;
+
+	BlackboardComponent->SetValue<UBlackboardKeyType_Bool>(InAttackRangeKey, bInAttackRange);
+}
+
+void AEnemyController::SetStunned(bool bStunned)
+{
+	if (StunnedKey == FBlackboard::InvalidKey) return;
+
+	BlackboardComponent->SetValue<UBlackboardKeyType_Bool>(StunnedKey, bStunned);
+}
+
+void AEnemyController::SetDead(bool bDead)
+{
+	if (DeadKey == FBlackboard::InvalidKey) return;
+
+	BlackboardComponent->SetValue<UBlackboardKeyType_Bool>(DeadKey, bDead);
+}
+
+void AEnemyController::SetCharacterDead(bool bCharacterDead)
+{
+	if (CharacterDeadKey == FBlackboard::InvalidKey) return;
+
+	BlackboardComponent->SetValue<UBlackboardKeyType_Bool>(CharacterDeadKey, bCharacterDead);
+}
+
+void AEnemyController::SetPatrolPoints(const FVector& PatrolPoint, const FVector& PatrolPoint2)
+{
+	if (PatrolPointKey != FBlackboard::InvalidKey)
+	{
+		BlackboardComponent->SetValue<UBlackboardKeyType_Vector>(PatrolPointKey, PatrolPoint);
+	}
+	if (PatrolPoint2Key != FBlackboard::InvalidKey)
+	{
+		BlackboardComponent->SetValue<UBlackboardKeyType_Vector>(PatrolPoint2Key, PatrolPoint2);
+	}
+}
+
+void AEnemyController::SetLODTier(EEnemyLODTier Tier)
+{
+	//RunBehaviorTree may have created its own component, the brain is the one actually running
+	UBrainComponent* Brain = GetBrainComponent();
+	if (Brain == nullptr) return;
+
+	switch (Tier)
+	{
+	case EEnemyLODTier::EELT_Reduced:
+		Brain->SetComponentTickInterval(ReducedBehaviorTickInterval);
+		break;
+	case EEnemyLODTier::EELT_Minimal:
+		Brain->SetComponentTickInterval(MinimalBehaviorTickInterval);
+		break;
+	default:
+		Brain->SetComponentTickInterval(0.f);
+		break;
+	}
+}
@@ -4,8 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "EnemyLODTier.h"
 #include "EnemyController.generated.h"
 
+class UBlackboardKeyType;
+
 /**
  * 
  */
@@ -17,8 +21,22 @@ class MEDIEVALGAMEENVIRONMENT_API AEnemyController : public AAIController
 public:
 	AEnemyController();
 	virtual void OnPossess(APawn* InPawn) override;
+
+	//typed blackboard writes through the key IDs resolved on possession
+	void SetTarget(AActor* Target);
+	void SetInAttackRange(bool bInAttackRange);
+	void SetStunned(bool bStunned);
+	void SetDead(bool bDead);
+	void SetCharacterDead(bool bCharacterDead);
+	void SetPatrolPoints(const FVector& PatrolPoint, const FVector& PatrolPoint2);
+
+	//throttles the behavior tree tick for the AI LOD tier of the possessed enemy
+	void SetLODTier(EEnemyLODTier Tier);
 	
 private:
+	//looks up the key in the current blackboard and logs an error if it is missing or of another type
+	FBlackboard::FKey ResolveKey(FName KeyName, TSubclassOf<UBlackboardKeyType> KeyType) const;
+
 	//blackboard component of this enemy
 	UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
 	class UBlackboardComponent* BlackboardComponent;
@@ -27,6 +45,23 @@ private:
 	UPROPERTY(BlueprintReadWrite, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
 	class UBehaviorTreeComponent* BehaviorTreeComponent;
 
+	//key IDs of the enemy blackboard, InvalidKey until possession or when the asset lacks the key
+	FBlackboard::FKey TargetKey;
+	FBlackboard::FKey InAttackRangeKey;
+	FBlackboard::FKey StunnedKey;
+	FBlackboard::FKey DeadKey;
+	FBlackboard::FKey CharacterDeadKey;
+	FBlackboard::FKey PatrolPointKey;
+	FBlackboard::FKey PatrolPoint2Key;
+
+	//behavior tree tick interval of enemies off screen or at mid distance, 0 ticks every frame
+	UPROPERTY(EditDefaultsOnly, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
+	float ReducedBehaviorTickInterval;
+
+	//behavior tree tick interval of distant enemies nobody can see
+	UPROPERTY(EditDefaultsOnly, Category = "AI Behavior", meta = (AllowPrivateAccess = "true"))
+	float MinimalBehaviorTickInterval;
+
 public:
 	FORCEINLINE UBlackboardComponent* GetBlackboardComponent() const { return BlackboardComponent; }
 
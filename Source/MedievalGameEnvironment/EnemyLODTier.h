@@ -0,0 +1,11 @@
+#pragma once
+
+UENUM(BlueprintType)
+enum class EEnemyLODTier : uint8
+{
+	EELT_Full UMETA(DisplayName = "Full"),
+	EELT_Reduced UMETA(DisplayName = "Reduced"),
+	EELT_Minimal UMETA(DisplayName = "Minimal"),
+
+	EELT_MAX UMETA(DisplayName = "DefaultMAX")
+};
@@ -0,0 +1,251 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "EnemyPerceptionSubsystem.h"
+#include "Enemy.h"
+#include "Main.h"
+#include "Async/ParallelFor.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update Perception"), STAT_EnemyPerceptionUpdate, STATGROUP_EnemyPerception);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registered Enemies"), STAT_EnemyPerceptionRegistered, STATGROUP_EnemyPerception);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Tested"), STAT_EnemyPerceptionTested, STATGROUP_EnemyPerception);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Blackboard Changes"), STAT_EnemyPerceptionChanges, STATGROUP_EnemyPerception);
+
+static TAutoConsoleVariable<float> CVarPerceptionInterval(
+	TEXT("AI.PerceptionInterval"),
+	0.1f,
+	TEXT("Seconds between two updates of the enemies' agro and attack ranges. 0 updates every frame."),
+	ECVF_Default);
+
+//below this the ParallelFor overhead isn't worth it
+static const int32 MinCandidatesForParallelTest{ 64 };
+
+static void RunPerceptionBenchmark(const TArray<FString>& Args)
+{
+	const int32 Iterations{ Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100 };
+	const int32 EnemyCounts[] = { 10, 100, 250, 500, 1000 };
+
+	FRandomStream Random(1234);
+	for (const int32 NumEnemies : EnemyCounts)
+	{
+		//wraiths spread over a 200m square around the player, like a large open level
+		FEnemyPerceptionBatch Batch;
+		for (int32 i = 0; i < NumEnemies; i++)
+		{
+			const FVector Location{ Random.FRandRange(-10000.f, 10000.f), Random.FRandRange(-10000.f, 10000.f), 0.f };
+			Batch.Add(Location, 1500.f, 150.f);
+		}
+
+		const double StartTime{ FPlatformTime::Seconds() };
+		int32 NumInAgroRange{ 0 };
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			const FVector TargetLocation{ Random.FRandRange(-5000.f, 5000.f), Random.FRandRange(-5000.f, 5000.f), 0.f };
+			Batch.Update(TargetLocation);
+			NumInAgroRange += Batch.Flags.FilterByPredicate([](uint8 Flags) { return Flags != 0; }).Num();
+		}
+		const double ElapsedMs{ (FPlatformTime::Seconds() - StartTime) * 1000.0 };
+
+		UE_LOG(LogTemp, Log, TEXT("Perception benchmark: %4d enemies, %.4f ms per update, %.1f tested, %.1f in agro range"),
+			NumEnemies, ElapsedMs / Iterations, static_cast<float>(Batch.NumTested),
+			static_cast<float>(NumInAgroRange) / Iterations);
+	}
+}
+
+static FAutoConsoleCommand GPerceptionBenchmarkCommand(
+	TEXT("AI.PerceptionBenchmark"),
+	TEXT("Times batched perception updates for 10 to 1000 synthetic enemies. Usage: AI.PerceptionBenchmark [Iterations=100]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunPerceptionBenchmark));
+
+FEnemyPerceptionBatch::FEnemyPerceptionBatch() : NumTested(0), CellSize(2000.f), MaxAgroRadius(0.f)
+{
+}
+
+void FEnemyPerceptionBatch::Reset()
+{
+	Locations.Reset();
+	AgroRadii.Reset();
+	AttackRadii.Reset();
+	Flags.Reset();
+	DistancesSquared.Reset();
+	MaxAgroRadius = 0.f;
+}
+
+int32 FEnemyPerceptionBatch::Add(const FVector& Location, float AgroRadius, float AttackRadius)
+{
+	Locations.Add(Location);
+	AgroRadii.Add(AgroRadius);
+	AttackRadii.Add(AttackRadius);
+	Flags.Add(0);
+	DistancesSquared.Add(BIG_NUMBER);
+	MaxAgroRadius = FMath::Max3(MaxAgroRadius, AgroRadius, AttackRadius);
+	return Locations.Num() - 1;
+}
+
+void FEnemyPerceptionBatch::RemoveAtSwap(int32 Index)
+{
+	Locations.RemoveAtSwap(Index, 1, false);
+	AgroRadii.RemoveAtSwap(Index, 1, false);
+	AttackRadii.RemoveAtSwap(Index, 1, false);
+	Flags.RemoveAtSwap(Index, 1, false);
+	DistancesSquared.RemoveAtSwap(Index, 1, false);
+}
+
+FIntPoint FEnemyPerceptionBatch::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void FEnemyPerceptionBatch::Update(const FVector& TargetLocation, float TargetRadius)
+{
+	for (auto& Pair : Cells)
+	{
+		Pair.Value.Reset();
+	}
+	for (int32 i = 0; i < Locations.Num(); i++)
+	{
+		Cells.FindOrAdd(GetCell(Locations[i])).Add(i);
+	}
+
+	//only enemies in the cells the largest range can reach are tested, the rest are out of range
+	FMemory::Memzero(Flags.GetData(), Flags.Num());
+	Candidates.Reset();
+	const float QueryRadius{ MaxAgroRadius + TargetRadius };
+	const FIntPoint MinCell{ GetCell(TargetLocation - FVector(QueryRadius)) };
+	const FIntPoint MaxCell{ GetCell(TargetLocation + FVector(QueryRadius)) };
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			if (const TArray<int32>* CellEnemies = Cells.Find(FIntPoint(X, Y)))
+			{
+				Candidates.Append(*CellEnemies);
+			}
+		}
+	}
+	NumTested = Candidates.Num();
+
+	//ranges are sphere overlaps, so they reach TargetRadius further than the enemy's radius
+	ParallelFor(Candidates.Num(), [this, &TargetLocation, TargetRadius](int32 CandidateIndex)
+	{
+		const int32 i{ Candidates[CandidateIndex] };
+		const float DistanceSquared{ FVector::DistSquared(Locations[i], TargetLocation) };
+		DistancesSquared[i] = DistanceSquared;
+
+		uint8 NewFlags{ 0 };
+		if (DistanceSquared <= FMath::Square(AgroRadii[i] + TargetRadius))
+		{
+			NewFlags |= EPF_InAgroRange;
+		}
+		if (DistanceSquared <= FMath::Square(AttackRadii[i] + TargetRadius))
+		{
+			NewFlags |= EPF_InAttackRange;
+		}
+		Flags[i] = NewFlags;
+	}, Candidates.Num() < MinCandidatesForParallelTest);
+}
+
+UEnemyPerceptionSubsystem::UEnemyPerceptionSubsystem() : TimeSinceUpdate(0.f)
+{
+}
+
+void UEnemyPerceptionSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr || Enemies.Contains(Enemy)) return;
+
+	Enemies.Add(Enemy);
+	Batch.Add(Enemy->GetActorLocation(), Enemy->GetAgroRadius(), Enemy->GetAttackRadius());
+	PreviousFlags.Add(0);
+}
+
+void UEnemyPerceptionSubsystem::UnregisterEnemy(AEnemy* Enemy)
+{
+	const int32 Index{ Enemies.Find(Enemy) };
+	if (Index == INDEX_NONE) return;
+
+	Enemies.RemoveAtSwap(Index, 1, false);
+	Batch.RemoveAtSwap(Index);
+	PreviousFlags.RemoveAtSwap(Index, 1, false);
+}
+
+void UEnemyPerceptionSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < CVarPerceptionInterval.GetValueOnGameThread()) return;
+
+	TimeSinceUpdate = 0.f;
+	UpdatePerception();
+}
+
+void UEnemyPerceptionSubsystem::UpdatePerception()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EnemyPerceptionUpdate);
+
+	AMain* Character = Cast<AMain>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
+	if (Character == nullptr) return;
+
+	//enemies destroyed without unregistering were nulled by the GC
+	for (int32 i = Enemies.Num() - 1; i >= 0; i--)
+	{
+		if (Enemies[i] == nullptr)
+		{
+			Enemies.RemoveAtSwap(i, 1, false);
+			Batch.RemoveAtSwap(i);
+			PreviousFlags.RemoveAtSwap(i, 1, false);
+		}
+	}
+
+	for (int32 i = 0; i < Enemies.Num(); i++)
+	{
+		Batch.Locations[i] = Enemies[i]->GetActorLocation();
+	}
+	Batch.Update(Character->GetActorLocation(), Character->GetSimpleCollisionRadius());
+
+	//push only what changed since the last update
+	int32 NumChanges{ 0 };
+	for (int32 i = 0; i < Enemies.Num(); i++)
+	{
+		const uint8 Changed{ static_cast<uint8>(Batch.Flags[i] ^ PreviousFlags[i]) };
+		if (Changed == 0) continue;
+
+		PreviousFlags[i] = Batch.Flags[i];
+		AEnemy* Enemy{ Enemies[i] };
+		if ((Changed & FEnemyPerceptionBatch::EPF_InAgroRange) && (Batch.Flags[i] & FEnemyPerceptionBatch::EPF_InAgroRange))
+		{
+			Enemy->OnPlayerEnteredAgroRange(Character);
+			NumChanges++;
+		}
+		if (Changed & FEnemyPerceptionBatch::EPF_InAttackRange)
+		{
+			Enemy->SetPlayerInAttackRange((Batch.Flags[i] & FEnemyPerceptionBatch::EPF_InAttackRange) != 0);
+			NumChanges++;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_EnemyPerceptionRegistered, Enemies.Num());
+	SET_DWORD_STAT(STAT_EnemyPerceptionTested, Batch.NumTested);
+	SET_DWORD_STAT(STAT_EnemyPerceptionChanges, NumChanges);
+}
+
+bool UEnemyPerceptionSubsystem::IsTickable() const
+{
+	return Enemies.Num() > 0;
+}
+
+ETickableTickType UEnemyPerceptionSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UEnemyPerceptionSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UEnemyPerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEnemyPerceptionSubsystem, STATGROUP_Tickables);
+}
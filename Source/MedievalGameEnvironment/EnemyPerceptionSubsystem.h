@@ -0,0 +1,98 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "EnemyPerceptionSubsystem.generated.h"
+
+class AEnemy;
+
+DECLARE_STATS_GROUP(TEXT("EnemyPerception"), STATGROUP_EnemyPerception, STATCAT_Advanced);
+
+/**
+ * Range checks of many enemies against one target. Enemies are bucketed in a uniform grid so only the cells
+ * around the target are tested, and the tests of those enemies run in a ParallelFor.
+ */
+struct MEDIEVALGAMEENVIRONMENT_API FEnemyPerceptionBatch
+{
+	enum EPerceptionFlags : uint8
+	{
+		EPF_InAgroRange = 1 << 0,
+		EPF_InAttackRange = 1 << 1
+	};
+
+	FEnemyPerceptionBatch();
+
+	void Reset();
+	int32 Add(const FVector& Location, float AgroRadius, float AttackRadius);
+	void RemoveAtSwap(int32 Index);
+
+	//recomputes Flags and DistancesSquared of every enemy for a target of TargetRadius at TargetLocation
+	void Update(const FVector& TargetLocation, float TargetRadius = 0.f);
+
+	FORCEINLINE int32 Num() const { return Locations.Num(); }
+
+	//one entry per enemy, every array has the same length
+	TArray<FVector> Locations;
+	TArray<float> AgroRadii;
+	TArray<float> AttackRadii;
+	TArray<uint8> Flags;
+
+	//squared distance to the target, only valid for enemies near enough to be tested
+	TArray<float> DistancesSquared;
+
+	//enemies tested in the last update
+	int32 NumTested;
+
+	float CellSize;
+
+private:
+	FIntPoint GetCell(const FVector& Location) const;
+
+	//rebuilt every update, positions change all the time
+	TMap<FIntPoint, TArray<int32>> Cells;
+	TArray<int32> Candidates;
+	float MaxAgroRadius;
+};
+
+/**
+ * Tells enemies when the player enters or leaves their agro and attack ranges, in place of an overlap sphere
+ * pair per enemy. All registered enemies are checked together on a fixed interval (AI.PerceptionInterval)
+ * and only changes are pushed to the enemies and their blackboards.
+ */
+UCLASS()
+class MEDIEVALGAMEENVIRONMENT_API UEnemyPerceptionSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UEnemyPerceptionSubsystem();
+
+	void RegisterEnemy(AEnemy* Enemy);
+	void UnregisterEnemy(AEnemy* Enemy);
+
+	FORCEINLINE int32 GetNumEnemies() const { return Enemies.Num(); }
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	void UpdatePerception();
+
+	UPROPERTY(Transient)
+	TArray<AEnemy*> Enemies;
+
+	//same order as Enemies
+	FEnemyPerceptionBatch Batch;
+
+	//flags pushed to each enemy by the previous update
+	TArray<uint8> PreviousFlags;
+
+	float TimeSinceUpdate;
+};
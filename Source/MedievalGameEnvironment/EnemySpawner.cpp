@@ -0,0 +1,177 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "EnemySpawner.h"
+#include "Enemy.h"
+#include "Kismet/GameplayStatics.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommandWithWorld GDumpEnemySpawnerStatsCommand(
+	TEXT("EnemySpawner.DumpStats"),
+	TEXT("Logs pool usage and spawn latency percentiles of every enemy spawner."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		for (TActorIterator<AEnemySpawner> It(World); It; ++It)
+		{
+			It->DumpStats();
+		}
+	}));
+
+AEnemySpawner::AEnemySpawner(): PrewarmCount(10), SpawnRadius(500.f), bStartWavesOnBeginPlay(true), CurrentWave(INDEX_NONE),
+	SpawnedInWave(0), PoolHits(0), PoolMisses(0)
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
+}
+
+void AEnemySpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//pay for constructing the enemies (components, controller, blackboard) while the level loads
+	if (EnemyClass)
+	{
+		for (int32 i = 0; i < PrewarmCount; i++)
+		{
+			AEnemy* Enemy = CreateEnemy(GetActorTransform());
+			if (Enemy == nullptr) break;
+
+			Enemy->ParkInPool();
+			PooledEnemies.Add(Enemy);
+		}
+	}
+
+	if (bStartWavesOnBeginPlay)
+	{
+		StartWaves();
+	}
+}
+
+void AEnemySpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(WaveTimer);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AEnemySpawner::StartWaves()
+{
+	CurrentWave = INDEX_NONE;
+	StartNextWave();
+}
+
+void AEnemySpawner::StartNextWave()
+{
+	CurrentWave++;
+	SpawnedInWave = 0;
+	if (!Waves.IsValidIndex(CurrentWave)) return;
+
+	GetWorldTimerManager().SetTimer(WaveTimer, this, &AEnemySpawner::SpawnWaveEnemy, Waves[CurrentWave].StartDelay, false);
+}
+
+void AEnemySpawner::SpawnWaveEnemy()
+{
+	if (!Waves.IsValidIndex(CurrentWave)) return;
+
+	const FEnemyWave& Wave = Waves[CurrentWave];
+	SpawnEnemy();
+	SpawnedInWave++;
+
+	if (SpawnedInWave < Wave.Count)
+	{
+		GetWorldTimerManager().SetTimer(WaveTimer, this, &AEnemySpawner::SpawnWaveEnemy, Wave.SpawnInterval, false);
+	}
+}
+
+AEnemy* AEnemySpawner::SpawnEnemy()
+{
+	if (EnemyClass == nullptr) return nullptr;
+
+	const double StartTime{ FPlatformTime::Seconds() };
+	const FTransform SpawnTransform{ GetSpawnTransform() };
+
+	AEnemy* Enemy{ nullptr };
+	while (Enemy == nullptr && PooledEnemies.Num() > 0)
+	{
+		//skips enemies destroyed while parked
+		AEnemy* Candidate{ PooledEnemies.Pop(false) };
+		if (IsValid(Candidate))
+		{
+			Enemy = Candidate;
+		}
+	}
+
+	if (Enemy)
+	{
+		Enemy->ResetForReuse(SpawnTransform);
+		PoolHits++;
+	}
+	else
+	{
+		Enemy = CreateEnemy(SpawnTransform);
+		PoolMisses++;
+	}
+
+	if (Enemy)
+	{
+		ActiveEnemies.Add(Enemy);
+	}
+
+	SpawnLatencies.Add(static_cast<float>((FPlatformTime::Seconds() - StartTime) * 1000.0));
+	return Enemy;
+}
+
+void AEnemySpawner::ReleaseEnemy(AEnemy* Enemy)
+{
+	if (Enemy == nullptr) return;
+
+	ActiveEnemies.RemoveSingleSwap(Enemy, false);
+	Enemy->ParkInPool();
+	PooledEnemies.Add(Enemy);
+
+	//the wave is over once all of its enemies are back in the pool
+	const bool bWaveSpawned{ Waves.IsValidIndex(CurrentWave) && SpawnedInWave >= Waves[CurrentWave].Count };
+	if (bWaveSpawned && ActiveEnemies.Num() == 0)
+	{
+		StartNextWave();
+	}
+}
+
+AEnemy* AEnemySpawner::CreateEnemy(const FTransform& Transform)
+{
+	AEnemy* Enemy = GetWorld()->SpawnActorDeferred<AEnemy>(EnemyClass, Transform, this, nullptr,
+		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (Enemy == nullptr) return nullptr;
+
+	//spawned enemies need their controller before BeginPlay reads the blackboard
+	Enemy->AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+	Enemy->SetSpawner(this);
+	UGameplayStatics::FinishSpawningActor(Enemy, Transform);
+	return Enemy;
+}
+
+FTransform AEnemySpawner::GetSpawnTransform() const
+{
+	const FVector2D Offset{ FMath::RandPointInCircle(SpawnRadius) };
+	const FRotator Rotation{ 0.f, FMath::FRandRange(-180.f, 180.f), 0.f };
+	return FTransform(Rotation, GetActorLocation() + FVector(Offset, 0.f));
+}
+
+void AEnemySpawner::DumpStats() const
+{
+	UE_LOG(LogTemp, Log, TEXT("Enemy spawner %s: active %d, pooled %d, pool hits %d, misses %d"), *GetName(),
+		ActiveEnemies.Num(), PooledEnemies.Num(), PoolHits, PoolMisses);
+	if (SpawnLatencies.Num() == 0) return;
+
+	TArray<float> Sorted{ SpawnLatencies };
+	Sorted.Sort();
+	auto Percentile = [&Sorted](float Fraction)
+	{
+		const int32 Index{ FMath::Clamp(FMath::CeilToInt(Fraction * Sorted.Num()) - 1, 0, Sorted.Num() - 1) };
+		return Sorted[Index];
+	};
+	UE_LOG(LogTemp, Log, TEXT("Enemy spawner %s: %d spawns, latency p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms"),
+		*GetName(), Sorted.Num(), Percentile(0.5f), Percentile(0.9f), Percentile(0.99f), Sorted.Last());
+}
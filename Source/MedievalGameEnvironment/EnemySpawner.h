@@ -0,0 +1,101 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "EnemySpawner.generated.h"
+
+class AEnemy;
+
+USTRUCT(BlueprintType)
+struct FEnemyWave
+{
+	GENERATED_BODY()
+
+	//enemies spawned in the wave
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Count = 5;
+
+	//seconds before the first enemy of the wave, counted from the end of the previous wave
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float StartDelay = 2.f;
+
+	//seconds between two enemies of the wave
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float SpawnInterval = 0.5f;
+};
+
+/**
+ * Spawns waves of enemies around itself from a pool of pre-warmed enemies. Dead enemies come back to
+ * the pool instead of being destroyed and are reset when the next wave needs them.
+ */
+UCLASS()
+class MEDIEVALGAMEENVIRONMENT_API AEnemySpawner : public AActor
+{
+	GENERATED_BODY()
+	
+public:	
+	AEnemySpawner();
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	//starts the first wave
+	UFUNCTION(BlueprintCallable, Category = Spawning)
+	void StartWaves();
+
+	//takes an enemy from the pool (or spawns one if it is empty) and places it around the spawner
+	UFUNCTION(BlueprintCallable, Category = Spawning)
+	AEnemy* SpawnEnemy();
+
+	//parks a dead enemy in the pool
+	void ReleaseEnemy(AEnemy* Enemy);
+
+	FORCEINLINE int32 GetNumActive() const { return ActiveEnemies.Num(); }
+	FORCEINLINE int32 GetNumPooled() const { return PooledEnemies.Num(); }
+
+	//writes pool usage and spawn latency percentiles to the log
+	void DumpStats() const;
+
+private:
+	AEnemy* CreateEnemy(const FTransform& Transform);
+	FTransform GetSpawnTransform() const;
+
+	void StartNextWave();
+	void SpawnWaveEnemy();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Spawning, meta = (AllowPrivateAccess = "true"))
+	TSubclassOf<AEnemy> EnemyClass;
+
+	//enemies created and parked at level start
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Spawning, meta = (AllowPrivateAccess = "true"))
+	int32 PrewarmCount;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Spawning, meta = (AllowPrivateAccess = "true"))
+	TArray<FEnemyWave> Waves;
+
+	//enemies are placed at a random point within this distance of the spawner
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Spawning, meta = (AllowPrivateAccess = "true"))
+	float SpawnRadius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Spawning, meta = (AllowPrivateAccess = "true"))
+	bool bStartWavesOnBeginPlay;
+
+	UPROPERTY(Transient)
+	TArray<AEnemy*> PooledEnemies;
+
+	UPROPERTY(Transient)
+	TArray<AEnemy*> ActiveEnemies;
+
+	int32 CurrentWave;
+	int32 SpawnedInWave;
+	FTimerHandle WaveTimer;
+
+	//time taken by each SpawnEnemy call in milliseconds
+	TArray<float> SpawnLatencies;
+	int32 PoolHits;
+	int32 PoolMisses;
+};
@@ -0,0 +1,198 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "FXPoolSubsystem.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "GameFramework/WorldSettings.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommandWithWorld GDumpFXPoolStatsCommand(
+	TEXT("FX.DumpPoolStats"),
+	TEXT("Logs hit, miss, eviction and peak usage counters of the pooled particle components."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (World && World->GetSubsystem<UFXPoolSubsystem>())
+		{
+			World->GetSubsystem<UFXPoolSubsystem>()->DumpStats();
+		}
+	}));
+
+UFXPoolSubsystem::UFXPoolSubsystem() : PrewarmCount(8), MaxPerTemplate(32), BeamTargetParameter(TEXT("Target"))
+{
+}
+
+void UFXPoolSubsystem::Deinitialize()
+{
+	for (auto& Pair : Pools)
+	{
+		for (UParticleSystemComponent* Component : Pair.Value.Free)
+		{
+			if (Component)
+			{
+				Component->DestroyComponent();
+			}
+		}
+		for (UParticleSystemComponent* Component : Pair.Value.Active)
+		{
+			if (Component)
+			{
+				Component->DestroyComponent();
+			}
+		}
+	}
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+void UFXPoolSubsystem::PrewarmTemplate(UParticleSystem* Template)
+{
+	if (Template == nullptr) return;
+
+	FFXTemplatePool& Pool = Pools.FindOrAdd(Template);
+	const int32 TargetCount{ FMath::Min(PrewarmCount, MaxPerTemplate) };
+	while (Pool.Free.Num() + Pool.Active.Num() < TargetCount)
+	{
+		UParticleSystemComponent* Component = CreatePooledComponent(Template);
+		if (Component == nullptr) break;
+
+		Pool.Free.Add(Component);
+	}
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnEmitter(UParticleSystem* Template, const FTransform& Transform)
+{
+	UParticleSystemComponent* Component = AcquireComponent(Template);
+	if (Component)
+	{
+		Component->SetWorldLocationAndRotation(Transform.GetLocation(), Transform.GetRotation());
+		Component->SetRelativeScale3D(Transform.GetScale3D());
+		Component->Activate(true);
+	}
+	return Component;
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnEmitterAtLocation(UParticleSystem* Template, const FVector& Location,
+	const FRotator& Rotation)
+{
+	return SpawnEmitter(Template, FTransform(Rotation, Location));
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::SpawnBeam(UParticleSystem* Template, const FTransform& Transform,
+	const FVector& BeamTarget)
+{
+	UParticleSystemComponent* Component = AcquireComponent(Template);
+	if (Component)
+	{
+		Component->SetWorldLocationAndRotation(Transform.GetLocation(), Transform.GetRotation());
+		Component->SetRelativeScale3D(Transform.GetScale3D());
+		//the target has to be set before activation so the first beam frame is already aimed
+		Component->SetVectorParameter(BeamTargetParameter, BeamTarget);
+		Component->Activate(true);
+	}
+	return Component;
+}
+
+FFXPoolStats UFXPoolSubsystem::GetTemplateStats(const UParticleSystem* Template) const
+{
+	const FFXTemplatePool* Pool = Pools.Find(Template);
+	return Pool ? Pool->Stats : FFXPoolStats();
+}
+
+FFXPoolStats UFXPoolSubsystem::GetTotalStats() const
+{
+	FFXPoolStats Total;
+	for (const auto& Pair : Pools)
+	{
+		Total.Hits += Pair.Value.Stats.Hits;
+		Total.Misses += Pair.Value.Stats.Misses;
+		Total.Evictions += Pair.Value.Stats.Evictions;
+		Total.InUse += Pair.Value.Stats.InUse;
+		Total.PeakInUse += Pair.Value.Stats.PeakInUse;
+	}
+	return Total;
+}
+
+void UFXPoolSubsystem::DumpStats() const
+{
+	for (const auto& Pair : Pools)
+	{
+		const FFXPoolStats& Stats = Pair.Value.Stats;
+		UE_LOG(LogTemp, Log, TEXT("FX pool %s: hits %d, misses %d, evictions %d, in use %d, peak %d, pooled %d"),
+			*GetNameSafe(Pair.Key), Stats.Hits, Stats.Misses, Stats.Evictions, Stats.InUse, Stats.PeakInUse,
+			Pair.Value.Free.Num() + Pair.Value.Active.Num());
+	}
+
+	const FFXPoolStats Total{ GetTotalStats() };
+	UE_LOG(LogTemp, Log, TEXT("FX pool total: hits %d, misses %d, evictions %d, in use %d"),
+		Total.Hits, Total.Misses, Total.Evictions, Total.InUse);
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::AcquireComponent(UParticleSystem* Template)
+{
+	if (Template == nullptr) return nullptr;
+
+	FFXTemplatePool& Pool = Pools.FindOrAdd(Template);
+	UParticleSystemComponent* Component = nullptr;
+
+	if (Pool.Free.Num() > 0)
+	{
+		//reuse an idle component
+		Component = Pool.Free.Pop(false);
+		++Pool.Stats.Hits;
+	}
+	else if (Pool.Active.Num() < MaxPerTemplate)
+	{
+		//pool is exhausted but still under the cap
+		Component = CreatePooledComponent(Template);
+		++Pool.Stats.Misses;
+	}
+	else
+	{
+		//cap reached, steal the oldest playing component
+		Component = Pool.Active[0];
+		Pool.Active.RemoveAt(0, 1, false);
+		++Pool.Stats.Evictions;
+	}
+
+	if (Component)
+	{
+		Pool.Active.Add(Component);
+		Pool.Stats.InUse = Pool.Active.Num();
+		Pool.Stats.PeakInUse = FMath::Max(Pool.Stats.PeakInUse, Pool.Stats.InUse);
+	}
+	return Component;
+}
+
+UParticleSystemComponent* UFXPoolSubsystem::CreatePooledComponent(UParticleSystem* Template)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->GetWorldSettings() == nullptr) return nullptr;
+
+	UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(World->GetWorldSettings(), NAME_None, RF_Transient);
+	Component->bAutoActivate = false;
+	Component->bAutoDestroy = false;
+	Component->SecondsBeforeInactive = 0.f;
+	Component->SetUsingAbsoluteLocation(true);
+	Component->SetUsingAbsoluteRotation(true);
+	Component->SetUsingAbsoluteScale(true);
+	Component->SetTemplate(Template);
+	Component->OnSystemFinished.AddDynamic(this, &UFXPoolSubsystem::OnPooledSystemFinished);
+	Component->RegisterComponentWithWorld(World);
+
+	return Component;
+}
+
+void UFXPoolSubsystem::OnPooledSystemFinished(UParticleSystemComponent* PSystem)
+{
+	if (PSystem == nullptr) return;
+
+	FFXTemplatePool* Pool = Pools.Find(PSystem->Template);
+	if (Pool && Pool->Active.RemoveSingle(PSystem) > 0)
+	{
+		Pool->Free.Add(PSystem);
+		Pool->Stats.InUse = Pool->Active.Num();
+	}
+}
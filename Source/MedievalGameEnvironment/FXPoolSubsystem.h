@@ -0,0 +1,109 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FXPoolSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+//hit/miss counters for one particle template (or for the whole pool)
+USTRUCT(BlueprintType)
+struct FFXPoolStats
+{
+	GENERATED_BODY()
+
+	//requests served by an idle pooled component
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Hits = 0;
+
+	//requests that had to create a new component
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Misses = 0;
+
+	//requests served by recycling the oldest active component because the cap was reached
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Evictions = 0;
+
+	//components currently playing
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 InUse = 0;
+
+	//highest number of components playing at the same time
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 PeakInUse = 0;
+};
+
+//pooled components for a single particle template
+USTRUCT()
+struct FFXTemplatePool
+{
+	GENERATED_BODY()
+
+	//idle components ready to be activated
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> Free;
+
+	//playing components, oldest first
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> Active;
+
+	UPROPERTY()
+	FFXPoolStats Stats;
+};
+
+/**
+ * Hands out pre-warmed particle system components instead of spawning a new one per effect.
+ * Components are returned to the pool when their system finishes.
+ */
+UCLASS(Config = Game)
+class MEDIEVALGAMEENVIRONMENT_API UFXPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UFXPoolSubsystem();
+
+	virtual void Deinitialize() override;
+
+	//creates idle components for the template up to PrewarmCount
+	void PrewarmTemplate(UParticleSystem* Template);
+
+	//activates a pooled component at the given transform (drop-in for UGameplayStatics::SpawnEmitterAtLocation)
+	UParticleSystemComponent* SpawnEmitter(UParticleSystem* Template, const FTransform& Transform);
+	UParticleSystemComponent* SpawnEmitterAtLocation(UParticleSystem* Template, const FVector& Location,
+		const FRotator& Rotation = FRotator::ZeroRotator);
+
+	//activates a pooled beam component and points its "Target" parameter at BeamTarget
+	UParticleSystemComponent* SpawnBeam(UParticleSystem* Template, const FTransform& Transform, const FVector& BeamTarget);
+
+	FFXPoolStats GetTemplateStats(const UParticleSystem* Template) const;
+	FFXPoolStats GetTotalStats() const;
+
+	//writes per-template stats to the log
+	void DumpStats() const;
+
+private:
+	UParticleSystemComponent* AcquireComponent(UParticleSystem* Template);
+	UParticleSystemComponent* CreatePooledComponent(UParticleSystem* Template);
+
+	//called by pooled components when their system has finished playing
+	UFUNCTION()
+	void OnPooledSystemFinished(UParticleSystemComponent* PSystem);
+
+	UPROPERTY(Transient)
+	TMap<UParticleSystem*, FFXTemplatePool> Pools;
+
+	//idle components created per template the first time it is used
+	UPROPERTY(Config)
+	int32 PrewarmCount;
+
+	//hard cap of components per template; the oldest active one is recycled past this
+	UPROPERTY(Config)
+	int32 MaxPerTemplate;
+
+	//name of the beam target vector parameter
+	FName BeamTargetParameter;
+};
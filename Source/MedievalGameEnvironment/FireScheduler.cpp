@@ -0,0 +1,123 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "FireScheduler.h"
+#include "HAL/IConsoleManager.h"
+
+//steps the scheduler with fixed or jittered frame times and checks the shot count against the fire rate.
+//the trigger is pulled either during input processing, before the pawn ticks in the same frame, or after the tick
+static void RunFireSchedulerTest(const TArray<FString>& Args)
+{
+	const float Interval{ Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 0.001f) : 0.1f };
+	const float Duration{ Args.Num() > 1 ? FMath::Max(FCString::Atof(*Args[1]), Interval) : 10.f };
+	//runs half an interval past the duration so no shot lands exactly on the end of the test
+	const double SimulatedDuration{ Duration + Interval * 0.5 };
+	const int32 ExpectedShots{ 1 + FMath::FloorToInt(SimulatedDuration / Interval) };
+
+	bool bAllPassed{ true };
+	FRandomStream Random(42);
+	for (const float FramesPerSecond : { 20.f, 30.f, 60.f, 90.f, 144.f, 240.f })
+	{
+		for (const bool bJitter : { false, true })
+		{
+			for (const bool bInputBeforeTick : { true, false })
+			{
+				FFireScheduler Scheduler;
+				TArray<float> ShotAges;
+				double Time{ 0.0 };
+				double LastShotTime{ 0.0 };
+				double MaxSpacingError{ 0.0 };
+				int32 NumShots{ 1 };
+				auto RecordShots = [&]()
+				{
+					for (const float ShotAge : ShotAges)
+					{
+						const double ShotTime{ Time - ShotAge };
+						MaxSpacingError = FMath::Max(MaxSpacingError, FMath::Abs(ShotTime - LastShotTime - Interval));
+						LastShotTime = ShotTime;
+						NumShots++;
+					}
+				};
+
+				uint64 FrameNumber{ 0 };
+				Scheduler.Start(Interval, FrameNumber);
+				if (bInputBeforeTick)
+				{
+					//the pawn ticks after the trigger pull with a DeltaTime that ended at the first shot
+					ShotAges.Reset();
+					Scheduler.Advance(1.f / FramesPerSecond, FrameNumber, true, MAX_int32, ShotAges);
+					RecordShots();
+				}
+
+				while (Time < SimulatedDuration)
+				{
+					float DeltaTime{ 1.f / FramesPerSecond };
+					if (bJitter)
+					{
+						DeltaTime *= Random.FRandRange(0.5f, 1.5f);
+					}
+					DeltaTime = FMath::Min(DeltaTime, static_cast<float>(SimulatedDuration - Time));
+					Time += DeltaTime;
+					FrameNumber++;
+
+					ShotAges.Reset();
+					Scheduler.Advance(DeltaTime, FrameNumber, true, MAX_int32, ShotAges);
+					RecordShots();
+				}
+
+				const bool bPassed{ NumShots == ExpectedShots && MaxSpacingError < 1.e-3 };
+				bAllPassed &= bPassed;
+				UE_LOG(LogTemp, Log, TEXT("Fire scheduler %s at %.0f fps%s, trigger %s tick: %d shots (expected %d), %.1f rpm, max spacing error %.3f ms"),
+					bPassed ? TEXT("passed") : TEXT("FAILED"), FramesPerSecond, bJitter ? TEXT(" jittered") : TEXT(""),
+					bInputBeforeTick ? TEXT("before") : TEXT("after"), NumShots, ExpectedShots, (NumShots - 1) * 60.f / Duration,
+					MaxSpacingError * 1000.f);
+			}
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Fire scheduler test %s"), bAllPassed ? TEXT("passed") : TEXT("FAILED"));
+}
+
+static FAutoConsoleCommand GFireSchedulerTestCommand(
+	TEXT("Weapon.FireSchedulerTest"),
+	TEXT("Steps the automatic fire scheduler at 20 to 240 fps and checks the shot count. Usage: Weapon.FireSchedulerTest [Interval=0.1] [Duration=10]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RunFireSchedulerTest));
+
+FFireScheduler::FFireScheduler() : Interval(0.1f), TimeUntilNextShot(0.f), StartFrameNumber(MAX_uint64), bActive(false)
+{
+}
+
+void FFireScheduler::Start(float NewInterval, uint64 FrameNumber)
+{
+	Interval = FMath::Max(NewInterval, KINDA_SMALL_NUMBER);
+	TimeUntilNextShot = Interval;
+	StartFrameNumber = FrameNumber;
+	bActive = true;
+}
+
+int32 FFireScheduler::Advance(float DeltaTime, uint64 FrameNumber, bool bTriggerHeld, int32 MaxShots, TArray<float>& OutShotAges)
+{
+	if (!bActive) return 0;
+
+	//input is handled before the pawn ticks, so a clock started this frame hasn't run for any of DeltaTime
+	if (FrameNumber != StartFrameNumber)
+	{
+		TimeUntilNextShot -= DeltaTime;
+	}
+
+	int32 NumShots{ 0 };
+	while (bTriggerHeld && TimeUntilNextShot <= 0.f && NumShots < MaxShots)
+	{
+		//-TimeUntilNextShot is how long ago this shot was due
+		OutShotAges.Add(-TimeUntilNextShot);
+		TimeUntilNextShot += Interval;
+		NumShots++;
+	}
+
+	if (TimeUntilNextShot <= 0.f)
+	{
+		//trigger released or out of shots, shots can't be banked
+		Stop();
+	}
+	return NumShots;
+}
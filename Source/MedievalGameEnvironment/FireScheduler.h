@@ -0,0 +1,38 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fixed-rate shot clock for automatic fire. Time is accumulated across frames, so every shot that falls
+ * due inside a frame is emitted with how long ago it was due, and the rate doesn't depend on the frame rate.
+ */
+struct MEDIEVALGAMEENVIRONMENT_API FFireScheduler
+{
+	FFireScheduler();
+
+	//fires the first shot now and starts the clock in frame FrameNumber
+	void Start(float NewInterval, uint64 FrameNumber);
+
+	//advances the clock by DeltaTime; while the trigger is held every shot that fell due is appended to
+	//OutShotAges as seconds before the end of the frame (oldest first), at most MaxShots of them.
+	//DeltaTime is ignored in the frame the clock started in, that time had passed before the first shot
+	int32 Advance(float DeltaTime, uint64 FrameNumber, bool bTriggerHeld, int32 MaxShots, TArray<float>& OutShotAges);
+
+	//stops firing, true once the last shot's interval has passed
+	FORCEINLINE bool IsCoolingDown() const { return bActive && TimeUntilNextShot > 0.f; }
+	FORCEINLINE bool IsActive() const { return bActive; }
+	FORCEINLINE void Stop() { bActive = false; TimeUntilNextShot = 0.f; }
+
+private:
+	float Interval;
+
+	//negative when a shot is overdue
+	float TimeUntilNextShot;
+
+	//GFrameCounter value of the frame Start was called in
+	uint64 StartFrameNumber;
+
+	bool bActive;
+};
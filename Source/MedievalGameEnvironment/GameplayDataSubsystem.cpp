@@ -0,0 +1,292 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "GameplayDataSubsystem.h"
+#include "Weapon.h"
+#include "Engine/DataTable.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static const TCHAR* ItemRarityTablePath{ TEXT("DataTable'/Game/Assets/DataTable/ItemRarityDataTable.ItemRarityDataTable'") };
+static const TCHAR* WeaponTablePath{ TEXT("DataTable'/Game/Assets/DataTable/WeaponDataTable.WeaponDataTable'") };
+
+//row names in enum order
+static const FName RarityRowNames[] = { FName("Damaged"), FName("Common"), FName("Uncommon"), FName("Rare"), FName("Legendary") };
+static const FName WeaponRowNames[] = { FName("Snipper"), FName("AssaultRifle") };
+
+static_assert(UE_ARRAY_COUNT(RarityRowNames) == static_cast<int32>(EItemRarity::EIR_MAX), "Every item rarity needs a row name");
+static_assert(UE_ARRAY_COUNT(WeaponRowNames) == static_cast<int32>(EWeaponType::EWT_MAX), "Every weapon type needs a row name");
+
+static FAutoConsoleCommandWithWorld GDumpGameplayDataCommand(
+	TEXT("GameplayData.DumpStats"),
+	TEXT("Logs how long the gameplay data tables took to load and how many rows they have."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		if (GameInstance && GameInstance->GetSubsystem<UGameplayDataSubsystem>())
+		{
+			GameInstance->GetSubsystem<UGameplayDataSubsystem>()->DumpStats();
+		}
+	}));
+
+FGameplayDataRegistry::FGameplayDataRegistry() : LoadTimeMs(0.0), NumRows(0), bLoaded(false)
+{
+}
+
+FGameplayDataRegistry::~FGameplayDataRegistry()
+{
+	Reset();
+}
+
+void FGameplayDataRegistry::Load()
+{
+	if (bLoaded) return;
+
+	const double StartTime{ FPlatformTime::Seconds() };
+
+	ItemRarityDataTable.Reset(Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, ItemRarityTablePath)));
+	WeaponDataTable.Reset(Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, WeaponTablePath)));
+
+	//row pointers go stale when a table is edited or reimported
+	for (UDataTable* Table : { ItemRarityDataTable.Get(), WeaponDataTable.Get() })
+	{
+		if (Table)
+		{
+			Table->OnDataTableChanged().AddRaw(this, &FGameplayDataRegistry::Flatten);
+		}
+	}
+
+	Flatten();
+	WeaponAssetRequests.SetNum(static_cast<int32>(EWeaponType::EWT_MAX));
+
+	//icon backgrounds are few and small, stream them all in up front
+	TArray<FSoftObjectPath> RarityAssets;
+	for (const FItemRarityTable* RarityRow : RarityRows)
+	{
+		if (RarityRow && !RarityRow->IconBackground.IsNull())
+		{
+			RarityAssets.Add(RarityRow->IconBackground.ToSoftObjectPath());
+		}
+	}
+	if (RarityAssets.Num() > 0)
+	{
+		RarityAssetsHandle = StreamableManager.RequestAsyncLoad(RarityAssets);
+		if (RarityAssetsHandle.IsValid() && !RarityAssetsHandle->HasLoadCompleted())
+		{
+			RarityAssetsHandle->BindCompleteDelegate(FStreamableDelegate::CreateRaw(this, &FGameplayDataRegistry::OnRarityAssetsLoaded));
+		}
+	}
+
+	LoadTimeMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	bLoaded = true;
+}
+
+EWeaponAssetState FGameplayDataRegistry::GetWeaponAssetState(EWeaponType WeaponType) const
+{
+	const int32 Index{ static_cast<int32>(WeaponType) };
+	const FWeaponDataTable* WeaponRow = GetWeaponData(WeaponType);
+	if (WeaponRow == nullptr || !WeaponAssetRequests.IsValidIndex(Index)) return EWeaponAssetState::EWAS_Unloaded;
+
+	const TSharedPtr<FStreamableHandle>& Handle = WeaponAssetRequests[Index].Handle;
+	if (Handle.IsValid())
+	{
+		return Handle->HasLoadCompleted() ? EWeaponAssetState::EWAS_Loaded : EWeaponAssetState::EWAS_Loading;
+	}
+
+	//not requested yet, but something else may have loaded them already
+	const bool bResident{
+		(WeaponRow->PickupSound.IsNull() || WeaponRow->PickupSound.IsValid()) &&
+		(WeaponRow->EquipSound.IsNull() || WeaponRow->EquipSound.IsValid()) &&
+		(WeaponRow->ItemMesh.IsNull() || WeaponRow->ItemMesh.IsValid()) &&
+		(WeaponRow->InventoryIcon.IsNull() || WeaponRow->InventoryIcon.IsValid()) &&
+		(WeaponRow->AmmoIcon.IsNull() || WeaponRow->AmmoIcon.IsValid()) &&
+		(WeaponRow->AnimBP.IsNull() || WeaponRow->AnimBP.IsValid()) };
+	return bResident ? EWeaponAssetState::EWAS_Loaded : EWeaponAssetState::EWAS_Unloaded;
+}
+
+void FGameplayDataRegistry::RequestWeaponAssets(EWeaponType WeaponType, FSimpleDelegate OnLoaded)
+{
+	const int32 Index{ static_cast<int32>(WeaponType) };
+	const FWeaponDataTable* WeaponRow = GetWeaponData(WeaponType);
+	if (WeaponRow == nullptr || !WeaponAssetRequests.IsValidIndex(Index))
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	FWeaponAssetRequest& Request = WeaponAssetRequests[Index];
+	if (Request.Handle.IsValid() && Request.Handle->HasLoadCompleted())
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	if (OnLoaded.IsBound())
+	{
+		Request.Callbacks.Add(OnLoaded);
+	}
+
+	//already loading, the callback is served by that load
+	if (Request.Handle.IsValid()) return;
+
+	TArray<FSoftObjectPath> AssetPaths;
+	for (const FSoftObjectPath& AssetPath : { WeaponRow->PickupSound.ToSoftObjectPath(), WeaponRow->EquipSound.ToSoftObjectPath(),
+		WeaponRow->ItemMesh.ToSoftObjectPath(), WeaponRow->InventoryIcon.ToSoftObjectPath(), WeaponRow->AmmoIcon.ToSoftObjectPath(),
+		WeaponRow->AnimBP.ToSoftObjectPath() })
+	{
+		if (!AssetPath.IsNull())
+		{
+			AssetPaths.Add(AssetPath);
+		}
+	}
+
+	//the streamable manager defers its delegate by a frame even when everything is resident, so only bind it
+	//when there is something left to load
+	Request.Handle = StreamableManager.RequestAsyncLoad(AssetPaths);
+	if (Request.Handle.IsValid() && !Request.Handle->HasLoadCompleted())
+	{
+		Request.Handle->BindCompleteDelegate(FStreamableDelegate::CreateRaw(this, &FGameplayDataRegistry::OnWeaponAssetsLoaded, Index));
+	}
+	else
+	{
+		//nothing to load or already resident
+		OnWeaponAssetsLoaded(Index);
+	}
+}
+
+void FGameplayDataRegistry::RequestRarityAssets(FSimpleDelegate OnLoaded)
+{
+	if (!RarityAssetsHandle.IsValid() || RarityAssetsHandle->HasLoadCompleted())
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	if (OnLoaded.IsBound())
+	{
+		RarityAssetCallbacks.Add(OnLoaded);
+	}
+}
+
+void FGameplayDataRegistry::OnRarityAssetsLoaded()
+{
+	TArray<FSimpleDelegate> Callbacks{ MoveTemp(RarityAssetCallbacks) };
+	RarityAssetCallbacks.Reset();
+	for (const FSimpleDelegate& Callback : Callbacks)
+	{
+		Callback.ExecuteIfBound();
+	}
+}
+
+void FGameplayDataRegistry::OnWeaponAssetsLoaded(int32 WeaponTypeIndex)
+{
+	if (!WeaponAssetRequests.IsValidIndex(WeaponTypeIndex)) return;
+
+	//callbacks may request other weapon types
+	TArray<FSimpleDelegate> Callbacks{ MoveTemp(WeaponAssetRequests[WeaponTypeIndex].Callbacks) };
+	WeaponAssetRequests[WeaponTypeIndex].Callbacks.Reset();
+	for (const FSimpleDelegate& Callback : Callbacks)
+	{
+		Callback.ExecuteIfBound();
+	}
+}
+
+void FGameplayDataRegistry::Reset()
+{
+	for (UDataTable* Table : { ItemRarityDataTable.Get(), WeaponDataTable.Get() })
+	{
+		if (Table)
+		{
+			Table->OnDataTableChanged().RemoveAll(this);
+		}
+	}
+
+	for (FWeaponAssetRequest& Request : WeaponAssetRequests)
+	{
+		if (Request.Handle.IsValid())
+		{
+			Request.Handle->CancelHandle();
+		}
+	}
+	WeaponAssetRequests.Reset();
+	RarityAssetCallbacks.Reset();
+	if (RarityAssetsHandle.IsValid())
+	{
+		RarityAssetsHandle->CancelHandle();
+		RarityAssetsHandle.Reset();
+	}
+
+	ItemRarityDataTable.Reset();
+	WeaponDataTable.Reset();
+	RarityRows.Reset();
+	WeaponRows.Reset();
+	NumRows = 0;
+	bLoaded = false;
+}
+
+void FGameplayDataRegistry::Flatten()
+{
+	RarityRows.Init(nullptr, static_cast<int32>(EItemRarity::EIR_MAX));
+	WeaponRows.Init(nullptr, static_cast<int32>(EWeaponType::EWT_MAX));
+	NumRows = 0;
+
+	if (ItemRarityDataTable.IsValid())
+	{
+		for (int32 i = 0; i < RarityRows.Num(); i++)
+		{
+			RarityRows[i] = ItemRarityDataTable->FindRow<FItemRarityTable>(RarityRowNames[i], TEXT("GameplayDataRegistry"));
+		}
+		NumRows += ItemRarityDataTable->GetRowMap().Num();
+	}
+
+	if (WeaponDataTable.IsValid())
+	{
+		for (int32 i = 0; i < WeaponRows.Num(); i++)
+		{
+			WeaponRows[i] = WeaponDataTable->FindRow<FWeaponDataTable>(WeaponRowNames[i], TEXT("GameplayDataRegistry"));
+		}
+		NumRows += WeaponDataTable->GetRowMap().Num();
+	}
+}
+
+void UGameplayDataSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Registry.Load();
+	DumpStats();
+}
+
+void UGameplayDataSubsystem::Deinitialize()
+{
+	Registry.Reset();
+
+	Super::Deinitialize();
+}
+
+FGameplayDataRegistry& UGameplayDataSubsystem::GetRegistry(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	UGameplayDataSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UGameplayDataSubsystem>() : nullptr;
+	if (Subsystem)
+	{
+		return Subsystem->Registry;
+	}
+
+	//editor worlds and CDOs have no game instance, they share one registry that lives until exit
+	static FGameplayDataRegistry* SharedRegistry = new FGameplayDataRegistry();
+	SharedRegistry->Load();
+	return *SharedRegistry;
+}
+
+EWeaponAssetState UGameplayDataSubsystem::GetWeaponAssetState(EWeaponType WeaponType) const
+{
+	return Registry.GetWeaponAssetState(WeaponType);
+}
+
+void UGameplayDataSubsystem::DumpStats() const
+{
+	UE_LOG(LogTemp, Log, TEXT("Gameplay data: %d rows loaded in %.2f ms"), Registry.GetNumRows(), Registry.GetLoadTimeMs());
+}
@@ -0,0 +1,127 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Engine/StreamableManager.h"
+#include "Item.h"
+#include "WeaponType.h"
+#include "GameplayDataSubsystem.generated.h"
+
+class UDataTable;
+struct FWeaponDataTable;
+
+UENUM(BlueprintType)
+enum class EWeaponAssetState : uint8
+{
+	EWAS_Unloaded UMETA(DisplayName = "Unloaded"),
+	EWAS_Loading UMETA(DisplayName = "Loading"),
+	EWAS_Loaded UMETA(DisplayName = "Loaded"),
+
+	EWAS_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+//the item rarity and weapon tables flattened into arrays indexed by their enums
+struct MEDIEVALGAMEENVIRONMENT_API FGameplayDataRegistry
+{
+	FGameplayDataRegistry();
+	~FGameplayDataRegistry();
+
+	//the tables keep a pointer to the registry for their change notifications
+	FGameplayDataRegistry(const FGameplayDataRegistry&) = delete;
+	FGameplayDataRegistry& operator=(const FGameplayDataRegistry&) = delete;
+
+	//loads both tables (once) and rebuilds the lookup arrays
+	void Load();
+	void Reset();
+
+	FORCEINLINE bool IsLoaded() const { return bLoaded; }
+
+	FORCEINLINE const FItemRarityTable* GetRarityData(EItemRarity Rarity) const
+	{
+		const int32 Index{ static_cast<int32>(Rarity) };
+		return RarityRows.IsValidIndex(Index) ? RarityRows[Index] : nullptr;
+	}
+
+	FORCEINLINE const FWeaponDataTable* GetWeaponData(EWeaponType WeaponType) const
+	{
+		const int32 Index{ static_cast<int32>(WeaponType) };
+		return WeaponRows.IsValidIndex(Index) ? WeaponRows[Index] : nullptr;
+	}
+
+	//streams in mesh, sounds, icons and anim class of the weapon type, OnLoaded runs once they are in memory;
+	//requests for a type that is already loading share its load
+	void RequestWeaponAssets(EWeaponType WeaponType, FSimpleDelegate OnLoaded = FSimpleDelegate());
+
+	EWeaponAssetState GetWeaponAssetState(EWeaponType WeaponType) const;
+
+	//OnLoaded runs once the rarity icon backgrounds streamed in by Load are in memory, right away if they already are
+	void RequestRarityAssets(FSimpleDelegate OnLoaded);
+
+	FORCEINLINE double GetLoadTimeMs() const { return LoadTimeMs; }
+	FORCEINLINE int32 GetNumRows() const { return NumRows; }
+
+private:
+	//fills the row arrays from the loaded tables
+	void Flatten();
+
+	void OnWeaponAssetsLoaded(int32 WeaponTypeIndex);
+	void OnRarityAssetsLoaded();
+
+	//asset load of one weapon type and the callbacks waiting for it
+	struct FWeaponAssetRequest
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		TArray<FSimpleDelegate> Callbacks;
+	};
+
+	FStreamableManager StreamableManager;
+
+	//index is EWeaponType, handles stay alive to keep the assets loaded
+	TArray<FWeaponAssetRequest> WeaponAssetRequests;
+
+	//keeps the rarity icon backgrounds loaded
+	TSharedPtr<FStreamableHandle> RarityAssetsHandle;
+	TArray<FSimpleDelegate> RarityAssetCallbacks;
+
+	TStrongObjectPtr<UDataTable> ItemRarityDataTable;
+	TStrongObjectPtr<UDataTable> WeaponDataTable;
+
+	//rows point into the tables above, which are kept alive by this registry
+	TArray<const FItemRarityTable*> RarityRows;
+	TArray<const FWeaponDataTable*> WeaponRows;
+
+	double LoadTimeMs;
+	int32 NumRows;
+	bool bLoaded;
+};
+
+/**
+ * Loads the gameplay data tables once per game instance and serves their rows by enum,
+ * instead of every item and weapon loading the tables and searching them by name on construction.
+ */
+UCLASS()
+class MEDIEVALGAMEENVIRONMENT_API UGameplayDataSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//registry of the game instance the object lives in, or a shared one when there is none (editor construction scripts)
+	static FGameplayDataRegistry& GetRegistry(const UObject* WorldContextObject);
+
+	FORCEINLINE FGameplayDataRegistry& GetData() { return Registry; }
+
+	UFUNCTION(BlueprintCallable, Category = GameplayData)
+	EWeaponAssetState GetWeaponAssetState(EWeaponType WeaponType) const;
+
+	//writes load time and row counts to the log
+	void DumpStats() const;
+
+private:
+	FGameplayDataRegistry Registry;
+};
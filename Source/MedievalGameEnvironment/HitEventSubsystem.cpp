@@ -0,0 +1,106 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "HitEventSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+#include "WhipHitInterface.h"
+#include "Algo/StableSort.h"
+
+void UHitEventSubsystem::QueueHit(const FHitResult& HitResult, float Damage, AController* InstigatorController,
+	AActor* DamageCauser)
+{
+	if (!HitResult.Actor.IsValid()) return;
+
+	FWhipHitRecord& Record = PendingHits.AddDefaulted_GetRef();
+	Record.HitActor = HitResult.Actor;
+	Record.BodyIndex = HitResult.Item;
+	Record.BoneName = HitResult.BoneName;
+	Record.Location = HitResult.Location;
+	Record.ImpactNormal = HitResult.ImpactNormal;
+	Record.InstigatorController = InstigatorController;
+	Record.DamageCauser = DamageCauser;
+	Record.Damage = Damage;
+}
+
+void UHitEventSubsystem::DispatchHits()
+{
+	if (PendingHits.Num() == 0) return;
+
+	//hit reactions may queue new hits, those go out next frame
+	Swap(PendingHits, DispatchingHits);
+	PendingHits.Reset();
+
+	//group the records by receiver, keeping the order of hits on the same receiver
+	Algo::StableSortBy(DispatchingHits, [](const FWhipHitRecord& Record) { return Record.HitActor.Get(); });
+
+	int32 GroupStart{ 0 };
+	while (GroupStart < DispatchingHits.Num())
+	{
+		const FWhipHitRecord& FirstRecord = DispatchingHits[GroupStart];
+		AActor* HitActor{ FirstRecord.HitActor.Get() };
+
+		float TotalDamage{ 0.f };
+		int32 GroupEnd{ GroupStart };
+		while (GroupEnd < DispatchingHits.Num() && DispatchingHits[GroupEnd].HitActor.Get() == HitActor)
+		{
+			TotalDamage += DispatchingHits[GroupEnd].Damage;
+			GroupEnd++;
+		}
+
+		if (HitActor && !HitActor->IsPendingKill())
+		{
+			if (HitActor->GetClass()->ImplementsInterface(UWhipHitInterface::StaticClass()))
+			{
+				//rebuild the parts of the hit result the receivers use
+				FHitResult HitResult;
+				HitResult.bBlockingHit = true;
+				HitResult.Actor = HitActor;
+				HitResult.Item = FirstRecord.BodyIndex;
+				HitResult.BoneName = FirstRecord.BoneName;
+				HitResult.Location = FirstRecord.Location;
+				HitResult.ImpactPoint = FirstRecord.Location;
+				HitResult.Normal = FirstRecord.ImpactNormal;
+				HitResult.ImpactNormal = FirstRecord.ImpactNormal;
+
+				//goes through the Blueprint event so overrides are honoured
+				IWhipHitInterface::Execute_WhipHit(HitActor, HitResult);
+			}
+
+			//the whip hit reaction may have destroyed the receiver
+			if (TotalDamage > 0.f && !HitActor->IsPendingKill())
+			{
+				UGameplayStatics::ApplyDamage(HitActor, TotalDamage, FirstRecord.InstigatorController.Get(),
+					FirstRecord.DamageCauser.Get(), UDamageType::StaticClass());
+			}
+		}
+
+		GroupStart = GroupEnd;
+	}
+
+	DispatchingHits.Reset();
+}
+
+void UHitEventSubsystem::Tick(float DeltaTime)
+{
+	DispatchHits();
+}
+
+bool UHitEventSubsystem::IsTickable() const
+{
+	return PendingHits.Num() > 0;
+}
+
+ETickableTickType UHitEventSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UHitEventSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UHitEventSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHitEventSubsystem, STATGROUP_Tickables);
+}
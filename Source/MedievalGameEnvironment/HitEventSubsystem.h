@@ -0,0 +1,62 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "HitEventSubsystem.generated.h"
+
+//compact record of a single whip hit waiting to be dispatched
+USTRUCT()
+struct FWhipHitRecord
+{
+	GENERATED_BODY()
+
+	TWeakObjectPtr<AActor> HitActor;
+
+	//physics body index (FHitResult::Item) and bone that were hit
+	int32 BodyIndex = INDEX_NONE;
+	FName BoneName;
+
+	FVector Location = FVector::ZeroVector;
+	FVector ImpactNormal = FVector::ZeroVector;
+
+	TWeakObjectPtr<AController> InstigatorController;
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	//damage to apply, 0 for hits that only trigger the whip hit reaction
+	float Damage = 0.f;
+};
+
+/**
+ * Collects whip hits during the frame and dispatches them once per frame, grouped by receiver:
+ * every hit actor gets a single WhipHit call and a single ApplyDamage with the summed damage.
+ */
+UCLASS()
+class MEDIEVALGAMEENVIRONMENT_API UHitEventSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	//records a hit for dispatch at the end of the frame
+	void QueueHit(const FHitResult& HitResult, float Damage, AController* InstigatorController, AActor* DamageCauser);
+
+	//dispatches every queued hit now
+	void DispatchHits();
+
+	FORCEINLINE int32 GetNumPendingHits() const { return PendingHits.Num(); }
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	TArray<FWhipHitRecord> PendingHits;
+
+	//records being dispatched, kept around to reuse the allocation
+	TArray<FWhipHitRecord> DispatchingHits;
+};
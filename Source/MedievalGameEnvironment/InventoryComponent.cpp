@@ -0,0 +1,318 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "InventoryComponent.h"
+#include "Item.h"
+#include "Weapon.h"
+#include "WeaponPoolSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static void RunInventoryBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	if (World == nullptr) return;
+
+	const int32 NumOperations{ Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000 };
+	const int32 Capacity{ Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 32 };
+	if (NumOperations <= 0 || Capacity <= 0) return;
+
+	UInventoryComponent* Inventory = NewObject<UInventoryComponent>(GetTransientPackage());
+	Inventory->SetCapacity(Capacity);
+
+	//enough loot to fill the inventory with some left on the ground
+	TArray<AItem*> Items;
+	TArray<AItem*> GroundItems;
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (int32 i = 0; i < Capacity + 8; i++)
+	{
+		AItem* Item = World->SpawnActor<AItem>(AItem::StaticClass(), FTransform::Identity, SpawnParams);
+		if (Item)
+		{
+			Items.Add(Item);
+			GroundItems.Add(Item);
+		}
+	}
+
+	FRandomStream Random(1234);
+	int32 NumPickups{ 0 };
+	int32 NumDrops{ 0 };
+	int32 NumSwaps{ 0 };
+
+	const double StartTime{ FPlatformTime::Seconds() };
+	for (int32 Operation = 0; Operation < NumOperations; Operation++)
+	{
+		const float Roll{ Random.FRand() };
+		if (Roll < 0.4f && GroundItems.Num() > 0 && !Inventory->IsFull())
+		{
+			Inventory->AddItem(GroundItems.Pop(false));
+			NumPickups++;
+		}
+		else if (Roll < 0.7f && Inventory->GetNumItems() > 0)
+		{
+			AItem* Dropped = Inventory->RemoveItem(Random.RandRange(0, Capacity - 1));
+			if (Dropped)
+			{
+				GroundItems.Add(Dropped);
+				NumDrops++;
+			}
+		}
+		else
+		{
+			Inventory->SwapSlots(Random.RandRange(0, Capacity - 1), Random.RandRange(0, Capacity - 1));
+			NumSwaps++;
+		}
+
+		//one event broadcast per simulated frame of 16 operations
+		if ((Operation & 15) == 15)
+		{
+			Inventory->FlushSlotEvents();
+		}
+	}
+	Inventory->FlushSlotEvents();
+	const double ElapsedSeconds{ FPlatformTime::Seconds() - StartTime };
+
+	UE_LOG(LogTemp, Log, TEXT("Inventory benchmark: %d operations (%d pickups, %d drops, %d swaps) on %d slots in %.3f ms, %.1f ns/op"),
+		NumOperations, NumPickups, NumDrops, NumSwaps, Capacity, ElapsedSeconds * 1000.0,
+		ElapsedSeconds * 1.0e9 / NumOperations);
+
+	for (AItem* Item : Items)
+	{
+		Item->Destroy();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GInventoryBenchmarkCommand(
+	TEXT("Inventory.Benchmark"),
+	TEXT("Runs random pickup/drop/swap operations against an inventory. Usage: Inventory.Benchmark [Operations=10000] [Capacity=32]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunInventoryBenchmark));
+
+UInventoryComponent::UInventoryComponent() : Capacity(2), NumItems(0)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	bWantsInitializeComponent = true;
+}
+
+void UInventoryComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	SetCapacity(Capacity);
+}
+
+void UInventoryComponent::SetCapacity(int32 NewCapacity)
+{
+	Capacity = FMath::Max(NewCapacity, 1);
+	Slots.SetNum(Capacity);
+	FreeSlotMask.SetNumZeroed(FMath::DivideAndRoundUp(Capacity, 64));
+
+	NumItems = 0;
+	for (int32 SlotIndex = 0; SlotIndex < Capacity; SlotIndex++)
+	{
+		SetSlotFree(SlotIndex, Slots[SlotIndex].IsEmpty());
+		if (!Slots[SlotIndex].IsEmpty())
+		{
+			NumItems++;
+		}
+	}
+}
+
+int32 UInventoryComponent::AddItem(AItem* Item)
+{
+	const int32 SlotIndex{ FindEmptySlot() };
+	if (SlotIndex != INDEX_NONE && AddItemAt(Item, SlotIndex))
+	{
+		return SlotIndex;
+	}
+	return INDEX_NONE;
+}
+
+bool UInventoryComponent::AddItemAt(AItem* Item, int32 SlotIndex)
+{
+	if (Item == nullptr || !IsValidSlot(SlotIndex) || !Slots[SlotIndex].IsEmpty()) return false;
+
+	Slots[SlotIndex].Item = Item;
+	Item->SetSlotIndex(SlotIndex);
+	SetSlotFree(SlotIndex, false);
+	NumItems++;
+
+	QueueSlotEvent(SlotIndex, EInventorySlotChange::EISC_Added);
+	return true;
+}
+
+AItem* UInventoryComponent::RemoveItem(int32 SlotIndex)
+{
+	if (!IsValidSlot(SlotIndex) || Slots[SlotIndex].IsEmpty()) return nullptr;
+
+	//the caller gets an actor back, so dehydrated weapons are brought back first
+	AItem* Item{ RehydrateSlot(SlotIndex) };
+	Slots[SlotIndex] = FInventorySlot();
+	SetSlotFree(SlotIndex, true);
+	NumItems--;
+
+	QueueSlotEvent(SlotIndex, EInventorySlotChange::EISC_Removed);
+	return Item;
+}
+
+AItem* UInventoryComponent::ReplaceItem(int32 SlotIndex, AItem* Item)
+{
+	if (!IsValidSlot(SlotIndex)) return nullptr;
+
+	AItem* OldItem{ RemoveItem(SlotIndex) };
+	AddItemAt(Item, SlotIndex);
+	return OldItem;
+}
+
+void UInventoryComponent::SwapSlots(int32 SlotA, int32 SlotB)
+{
+	if (SlotA == SlotB || !IsValidSlot(SlotA) || !IsValidSlot(SlotB)) return;
+
+	Swap(Slots[SlotA], Slots[SlotB]);
+	for (const int32 SlotIndex : { SlotA, SlotB })
+	{
+		FInventorySlot& Slot = Slots[SlotIndex];
+		SetSlotFree(SlotIndex, Slot.IsEmpty());
+		if (Slot.Item)
+		{
+			Slot.Item->SetSlotIndex(SlotIndex);
+		}
+		Slot.DehydratedWeapon.SlotIndex = SlotIndex;
+		QueueSlotEvent(SlotIndex, Slot.IsEmpty() ? EInventorySlotChange::EISC_Removed : EInventorySlotChange::EISC_Added);
+	}
+}
+
+bool UInventoryComponent::DehydrateSlot(int32 SlotIndex)
+{
+	if (!IsValidSlot(SlotIndex)) return false;
+
+	FInventorySlot& Slot = Slots[SlotIndex];
+	AWeapon* Weapon = Cast<AWeapon>(Slot.Item);
+	if (Weapon == nullptr) return false;
+
+	Slot.DehydratedWeapon = Weapon->Dehydrate();
+	Slot.Item = nullptr;
+
+	UWeaponPoolSubsystem* WeaponPool = GetWorld() ? GetWorld()->GetSubsystem<UWeaponPoolSubsystem>() : nullptr;
+	if (WeaponPool)
+	{
+		WeaponPool->ReleaseWeapon(Weapon);
+	}
+	else
+	{
+		Weapon->Destroy();
+	}
+	return true;
+}
+
+AItem* UInventoryComponent::RehydrateSlot(int32 SlotIndex)
+{
+	if (!IsValidSlot(SlotIndex)) return nullptr;
+
+	FInventorySlot& Slot = Slots[SlotIndex];
+	if (Slot.Item || !Slot.DehydratedWeapon.IsValid()) return Slot.Item;
+
+	UWeaponPoolSubsystem* WeaponPool = GetWorld() ? GetWorld()->GetSubsystem<UWeaponPoolSubsystem>() : nullptr;
+	if (WeaponPool == nullptr) return nullptr;
+
+	const FTransform SpawnTransform{ GetOwner() ? GetOwner()->GetActorTransform() : FTransform::Identity };
+	AWeapon* Weapon = WeaponPool->AcquireWeapon(Slot.DehydratedWeapon.WeaponClass, SpawnTransform);
+	if (Weapon)
+	{
+		Weapon->Rehydrate(Slot.DehydratedWeapon);
+		Weapon->SetSlotIndex(SlotIndex);
+		//back in the inventory but not yet equipped
+		Weapon->SetItemState(EItemState::EIS_PickedUp);
+		Slot.Item = Weapon;
+		Slot.DehydratedWeapon = FDehydratedWeapon();
+	}
+	return Slot.Item;
+}
+
+int32 UInventoryComponent::FindEmptySlot() const
+{
+	//one word covers 64 slots, so this is a single bit scan for any realistic loadout
+	for (int32 WordIndex = 0; WordIndex < FreeSlotMask.Num(); WordIndex++)
+	{
+		const uint64 Word{ FreeSlotMask[WordIndex] };
+		if (Word != 0)
+		{
+			return WordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Word));
+		}
+	}
+	return INDEX_NONE; //inventory is full
+}
+
+void UInventoryComponent::NotifyEquipped(int32 PreviousSlotIndex, int32 NewSlotIndex)
+{
+	QueueSlotEvent(NewSlotIndex, EInventorySlotChange::EISC_Equipped, PreviousSlotIndex);
+}
+
+void UInventoryComponent::NotifyHighlighted(int32 SlotIndex, bool bHighlighted)
+{
+	QueueSlotEvent(SlotIndex, bHighlighted ? EInventorySlotChange::EISC_Highlighted 
+		: EInventorySlotChange::EISC_Unhighlighted);
+}
+
+AItem* UInventoryComponent::GetItem(int32 SlotIndex) const
+{
+	return IsValidSlot(SlotIndex) ? Slots[SlotIndex].Item : nullptr;
+}
+
+bool UInventoryComponent::IsSlotOccupied(int32 SlotIndex) const
+{
+	return IsValidSlot(SlotIndex) && !Slots[SlotIndex].IsEmpty();
+}
+
+bool UInventoryComponent::GetDehydratedWeapon(int32 SlotIndex, FDehydratedWeapon& OutWeapon) const
+{
+	if (!IsValidSlot(SlotIndex) || !Slots[SlotIndex].DehydratedWeapon.IsValid()) return false;
+
+	OutWeapon = Slots[SlotIndex].DehydratedWeapon;
+	return true;
+}
+
+void UInventoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	FlushSlotEvents();
+}
+
+void UInventoryComponent::FlushSlotEvents()
+{
+	SetComponentTickEnabled(false);
+	if (PendingSlotEvents.Num() == 0) return;
+
+	//listeners may change the inventory again, those events go out with the next batch
+	TArray<FInventorySlotEvent> SlotEvents{ MoveTemp(PendingSlotEvents) };
+	PendingSlotEvents.Reset();
+	OnSlotsChanged.Broadcast(SlotEvents);
+}
+
+void UInventoryComponent::SetSlotFree(int32 SlotIndex, bool bFree)
+{
+	const uint64 Bit{ 1ull << (SlotIndex & 63) };
+	if (bFree)
+	{
+		FreeSlotMask[SlotIndex >> 6] |= Bit;
+	}
+	else
+	{
+		FreeSlotMask[SlotIndex >> 6] &= ~Bit;
+	}
+}
+
+void UInventoryComponent::QueueSlotEvent(int32 SlotIndex, EInventorySlotChange Change, int32 PreviousSlotIndex)
+{
+	FInventorySlotEvent& SlotEvent = PendingSlotEvents.AddDefaulted_GetRef();
+	SlotEvent.SlotIndex = SlotIndex;
+	SlotEvent.Change = Change;
+	SlotEvent.PreviousSlotIndex = PreviousSlotIndex;
+
+	//broadcast the batch on our next tick
+	if (!IsComponentTickEnabled())
+	{
+		SetComponentTickEnabled(true);
+	}
+}
@@ -0,0 +1,147 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Weapon.h"
+#include "InventoryComponent.generated.h"
+
+class AItem;
+
+UENUM(BlueprintType)
+enum class EInventorySlotChange : uint8
+{
+	EISC_Added UMETA(DisplayName = "Added"),
+	EISC_Removed UMETA(DisplayName = "Removed"),
+	EISC_Equipped UMETA(DisplayName = "Equipped"),
+	EISC_Highlighted UMETA(DisplayName = "Highlighted"),
+	EISC_Unhighlighted UMETA(DisplayName = "Unhighlighted"),
+
+	EISC_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+USTRUCT(BlueprintType)
+struct FInventorySlotEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 SlotIndex = INDEX_NONE;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	EInventorySlotChange Change = EInventorySlotChange::EISC_MAX;
+
+	//slot that was equipped before an EISC_Equipped event, -1 if none
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 PreviousSlotIndex = INDEX_NONE;
+};
+
+//contents of one inventory slot: a live item, a dehydrated weapon record, or nothing
+USTRUCT(BlueprintType)
+struct FInventorySlot
+{
+	GENERATED_BODY()
+
+	//live item, nullptr while the slot is empty or dehydrated
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	AItem* Item = nullptr;
+
+	//valid while the slot holds a weapon without an actor
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FDehydratedWeapon DehydratedWeapon;
+
+	FORCEINLINE bool IsEmpty() const { return Item == nullptr && !DehydratedWeapon.IsValid(); }
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInventorySlotsChangedDelegate, const TArray<FInventorySlotEvent>&, SlotEvents);
+
+/**
+ * Fixed-capacity item slots with a free-slot bitmask.
+ * Slot changes are collected and broadcast once per frame through OnSlotsChanged.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class MEDIEVALGAMEENVIRONMENT_API UInventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UInventoryComponent();
+
+	virtual void InitializeComponent() override;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	//resizes the slot storage, items past the new capacity are dropped from the inventory
+	void SetCapacity(int32 NewCapacity);
+
+	//puts the item into the first empty slot, returns the slot or -1 when full
+	int32 AddItem(AItem* Item);
+
+	//puts the item into a specific empty slot
+	bool AddItemAt(AItem* Item, int32 SlotIndex);
+
+	//empties the slot and returns the item that was in it
+	AItem* RemoveItem(int32 SlotIndex);
+
+	//puts the item into an occupied slot and returns the item it replaced
+	AItem* ReplaceItem(int32 SlotIndex, AItem* Item);
+
+	//exchanges the contents of two slots
+	void SwapSlots(int32 SlotA, int32 SlotB);
+
+	//turns the weapon in the slot into a record and hands its actor back to the weapon pool
+	bool DehydrateSlot(int32 SlotIndex);
+
+	//brings the weapon in the slot back as an actor (from the weapon pool) if it was dehydrated
+	AItem* RehydrateSlot(int32 SlotIndex);
+
+	//first empty slot, -1 when the inventory is full
+	int32 FindEmptySlot() const;
+
+	//queue slot events for the inventory bar
+	void NotifyEquipped(int32 PreviousSlotIndex, int32 NewSlotIndex);
+	void NotifyHighlighted(int32 SlotIndex, bool bHighlighted);
+
+	//broadcasts the queued slot events now instead of at the next tick
+	void FlushSlotEvents();
+
+	//live item in the slot, nullptr when the slot is empty or dehydrated
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	AItem* GetItem(int32 SlotIndex) const;
+
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	bool IsSlotOccupied(int32 SlotIndex) const;
+
+	//copies the record of a dehydrated weapon, false if the slot doesn't hold one
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	bool GetDehydratedWeapon(int32 SlotIndex, FDehydratedWeapon& OutWeapon) const;
+
+	FORCEINLINE bool IsValidSlot(int32 SlotIndex) const { return Slots.IsValidIndex(SlotIndex); }
+	FORCEINLINE bool IsFull() const { return NumItems >= Capacity; }
+	FORCEINLINE int32 GetNumItems() const { return NumItems; }
+	FORCEINLINE int32 GetCapacity() const { return Capacity; }
+
+	//all slot changes made during the frame
+	UPROPERTY(BlueprintAssignable, Category = Delegates)
+	FInventorySlotsChangedDelegate OnSlotsChanged;
+
+private:
+	void SetSlotFree(int32 SlotIndex, bool bFree);
+	void QueueSlotEvent(int32 SlotIndex, EInventorySlotChange Change, int32 PreviousSlotIndex = INDEX_NONE);
+
+	//number of inventory slots
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true", ClampMin = "1"))
+	int32 Capacity;
+
+	//slot storage
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
+	TArray<FInventorySlot> Slots;
+
+	//one bit per slot, set when the slot is empty
+	TArray<uint64> FreeSlotMask;
+
+	int32 NumItems;
+
+	TArray<FInventorySlotEvent> PendingSlotEvents;
+};
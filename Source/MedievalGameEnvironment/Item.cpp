@@ -7,6 +7,211 @@
 #include "Components/SphereComponent.h"
 #include "Main.h"
 #include "Camera/CameraComponent.h"
+#include "GameplayDataSubsystem.h"
+#include "ItemInterpSubsystem.h"
+#include "ItemProximitySubsystem.h"
+#include "SignificanceSubsystem.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarBakedItemStateProfiles(
+	TEXT("Item.BakedStateProfiles"),
+	1,
+	TEXT("1 applies the precomputed collision profile of an item state and skips unchanged settings, 0 uses the per-call legacy path."),
+	ECVF_Default);
+
+//collision settings of one component in one item state
+struct FItemComponentCollision
+{
+	ECollisionEnabled::Type CollisionEnabled = ECollisionEnabled::NoCollision;
+	FCollisionResponseContainer Responses = FCollisionResponseContainer(ECR_Ignore);
+};
+
+//everything SetItemProperties changes for one item state
+struct FItemStateProfile
+{
+	FItemComponentCollision Mesh;
+	FItemComponentCollision AreaSphere;
+	FItemComponentCollision CollisionBox;
+	bool bSimulatePhysics = false;
+	bool bMeshVisible = true;
+	bool bHidePickupWidget = false;
+};
+
+//profiles are built once, indexed by EItemState
+static const FItemStateProfile& GetItemStateProfile(EItemState State)
+{
+	static const TArray<FItemStateProfile> Profiles = []()
+	{
+		TArray<FItemStateProfile> Result;
+		Result.SetNum(static_cast<int32>(EItemState::EIS_MAX));
+
+		FItemStateProfile& Pickup = Result[static_cast<int32>(EItemState::EIS_Pickup)];
+		Pickup.CollisionBox.CollisionEnabled = ECollisionEnabled::QueryAndPhysics;
+		Pickup.CollisionBox.Responses.SetResponse(ECC_Visibility, ECR_Block);
+
+		FItemStateProfile& EquipInterping = Result[static_cast<int32>(EItemState::EIS_EquipInterping)];
+		EquipInterping.bHidePickupWidget = true;
+
+		FItemStateProfile& PickedUp = Result[static_cast<int32>(EItemState::EIS_PickedUp)];
+		PickedUp.bHidePickupWidget = true;
+		PickedUp.bMeshVisible = false;
+
+		FItemStateProfile& Equipped = Result[static_cast<int32>(EItemState::EIS_Equipped)];
+		Equipped.bHidePickupWidget = true;
+
+		FItemStateProfile& Falling = Result[static_cast<int32>(EItemState::EIS_Falling)];
+		Falling.bSimulatePhysics = true;
+		Falling.Mesh.CollisionEnabled = ECollisionEnabled::QueryAndPhysics;
+		Falling.Mesh.Responses.SetResponse(ECC_WorldStatic, ECR_Block);
+
+		return Result;
+	}();
+
+	const int32 Index{ static_cast<int32>(State) };
+	return Profiles.IsValidIndex(Index) ? Profiles[Index] : Profiles[0];
+}
+
+//only touches the body instance when something actually differs, each setter recreates physics state/overlaps
+static void ApplyComponentCollision(UPrimitiveComponent* Component, const FItemComponentCollision& Collision)
+{
+	if (Component == nullptr) return;
+
+	const FCollisionResponseContainer& CurrentResponses = Component->GetCollisionResponseToChannels();
+	if (FMemory::Memcmp(&CurrentResponses, &Collision.Responses, sizeof(FCollisionResponseContainer)) != 0)
+	{
+		Component->SetCollisionResponseToChannels(Collision.Responses);
+	}
+	if (Component->GetCollisionEnabled() != Collision.CollisionEnabled)
+	{
+		Component->SetCollisionEnabled(Collision.CollisionEnabled);
+	}
+}
+
+static void RunItemStateBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	if (World == nullptr) return;
+
+	const int32 NumItems{ Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000 };
+	const EItemState Cycle[] = { EItemState::EIS_Pickup, EItemState::EIS_EquipInterping, EItemState::EIS_PickedUp,
+		EItemState::EIS_Equipped, EItemState::EIS_Falling };
+	const int32 NumTransitions{ UE_ARRAY_COUNT(Cycle) };
+
+	TArray<AItem*> Items;
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (int32 i = 0; i < NumItems; i++)
+	{
+		//spread out so falling items don't collide with each other
+		const FVector Location{ (i % 32) * 200.f, (i / 32) * 200.f, 10000.f };
+		AItem* Item = World->SpawnActor<AItem>(AItem::StaticClass(), FTransform(Location), SpawnParams);
+		if (Item)
+		{
+			Items.Add(Item);
+		}
+	}
+
+	//every pass starts from the end of the cycle so the first transition does real work
+	for (AItem* Item : Items)
+	{
+		Item->SetItemState(Cycle[NumTransitions - 1]);
+	}
+
+	IConsoleVariable* BakedProfiles = CVarBakedItemStateProfiles.AsVariable();
+	const int32 PreviousValue{ CVarBakedItemStateProfiles.GetValueOnGameThread() };
+	for (const int32 bBaked : { 0, 1 })
+	{
+		BakedProfiles->Set(bBaked, ECVF_SetByCode);
+
+		double TransitionSeconds[UE_ARRAY_COUNT(Cycle)] = {};
+		for (int32 Transition = 0; Transition < NumTransitions; Transition++)
+		{
+			const double StartTime{ FPlatformTime::Seconds() };
+			for (AItem* Item : Items)
+			{
+				Item->SetItemState(Cycle[Transition]);
+			}
+			TransitionSeconds[Transition] = FPlatformTime::Seconds() - StartTime;
+		}
+
+		for (int32 Transition = 0; Transition < NumTransitions; Transition++)
+		{
+			const EItemState From{ Cycle[(Transition + NumTransitions - 1) % NumTransitions] };
+			UE_LOG(LogTemp, Log, TEXT("Item state benchmark (%s): %d -> %d, %.2f us per item"),
+				bBaked ? TEXT("baked") : TEXT("legacy"), static_cast<int32>(From), static_cast<int32>(Cycle[Transition]),
+				TransitionSeconds[Transition] * 1.0e6 / Items.Num());
+		}
+	}
+	BakedProfiles->Set(PreviousValue, ECVF_SetByCode);
+
+	for (AItem* Item : Items)
+	{
+		Item->Destroy();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GItemStateBenchmarkCommand(
+	TEXT("Item.StateBenchmark"),
+	TEXT("Cycles items through Pickup, EquipInterping, PickedUp, Equipped and Falling with the legacy and baked paths. Usage: Item.StateBenchmark [Items=1000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunItemStateBenchmark));
+
+static void RunItemSpawnBenchmark(const TArray<FString>& Args, UWorld* World)
+{
+	if (World == nullptr) return;
+
+	const int32 NumItems{ Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 500 };
+	TSubclassOf<AItem> ItemClass{ AItem::StaticClass() };
+	if (Args.Num() > 1)
+	{
+		UClass* RequestedClass = FindObject<UClass>(ANY_PACKAGE, *Args[1]);
+		if (RequestedClass && RequestedClass->IsChildOf(AItem::StaticClass()))
+		{
+			ItemClass = RequestedClass;
+		}
+	}
+
+	TArray<AItem*> Items;
+	Items.Reserve(NumItems);
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	const double StartTime{ FPlatformTime::Seconds() };
+	for (int32 i = 0; i < NumItems; i++)
+	{
+		const FVector Location{ (i % 32) * 200.f, (i / 32) * 200.f, 0.f };
+		AItem* Item = World->SpawnActor<AItem>(ItemClass, FTransform(Location), SpawnParams);
+		if (Item)
+		{
+			Items.Add(Item);
+		}
+	}
+	const double ElapsedSeconds{ FPlatformTime::Seconds() - StartTime };
+
+	//components and their memory for one item
+	int32 NumComponents{ 0 };
+	SIZE_T ComponentBytes{ 0 };
+	if (Items.Num() > 0)
+	{
+		for (UActorComponent* Component : Items[0]->GetComponents())
+		{
+			NumComponents++;
+			ComponentBytes += Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Item spawn benchmark: %d %s in %.3f ms, %.2f us per item, %d components and %llu bytes of components per item"),
+		Items.Num(), *GetNameSafe(ItemClass), ElapsedSeconds * 1000.0, ElapsedSeconds * 1.0e6 / FMath::Max(Items.Num(), 1),
+		NumComponents, static_cast<uint64>(ComponentBytes));
+
+	for (AItem* Item : Items)
+	{
+		Item->Destroy();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GItemSpawnBenchmarkCommand(
+	TEXT("Item.SpawnBenchmark"),
+	TEXT("Spawns items and reports spawn time and per-item component memory. Usage: Item.SpawnBenchmark [Items=500] [ItemClass]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunItemSpawnBenchmark));
 
 // Sets default values
 AItem::AItem(): ItemName(FString("Default")), ItemCount(0), ItemRarity(EItemRarity::EIR_Common), 
@@ -15,8 +220,8 @@ ItemState(EItemState::EIS_Pickup),
 ZCurveTime(0.7f), ItemInterpStartLocation(FVector(0.f)), CameraTargetLocation(FVector(0.f)), bInterping(false), 
 ItemInterpX(0.f), ItemInterpY(0.f), InterpInitialYawOffset(0.f), SlotIndex(0), bCharacterInventoryFull(false)
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	//items don't tick, pickup interpolation runs in UItemInterpSubsystem
+	PrimaryActorTick.bCanEverTick = false;
 
 	ItemMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("ItemMesh"));
 	SetRootComponent(ItemMesh);
@@ -26,11 +231,16 @@ ItemInterpX(0.f), ItemInterpY(0.f), InterpInitialYawOffset(0.f), SlotIndex(0), b
 	CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	CollisionBox->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
 
+	//hidden until the player looks at the item, so it doesn't tick before then
 	PickupWidget = CreateDefaultSubobject<UWidgetComponent>(TEXT("PickupWidget"));
 	PickupWidget->SetupAttachment(GetRootComponent());
+	PickupWidget->PrimaryComponentTick.bStartWithTickEnabled = false;
 
+	//only the radius is used, proximity is found through UItemProximitySubsystem
 	AreaSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AreaSphere"));
 	AreaSphere->SetupAttachment(GetRootComponent());
+	AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AreaSphere->SetGenerateOverlapEvents(false);
 }
 
 // Called when the game starts or when spawned
@@ -39,54 +249,39 @@ void AItem::BeginPlay()
 	Super::BeginPlay();
 
 	//hide pickup widget
-	if (PickupWidget)
-	{
-		PickupWidget->SetVisibility(false);
-	}
+	SetPickupWidgetVisible(false);
+
 	//set activestars array based on item rarity
 	SetActiveStars();
 
-	//setup overlap for areasphere
-	AreaSphere->OnComponentBeginOverlap.AddDynamic(this, &AItem::OnSphereOverlap);
-	AreaSphere->OnComponentEndOverlap.AddDynamic(this, &AItem::OnSphereEndOverlap);
-
 	//set item properties based on itemstate
 	SetItemProperties(ItemState);
 	
 }
 
-void AItem::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	if (OtherActor)
+	if (UItemProximitySubsystem* Proximity = GetWorld()->GetSubsystem<UItemProximitySubsystem>())
 	{
-		AMain* MainCharacter = Cast<AMain>(OtherActor);
-		if (MainCharacter)
-		{
-			MainCharacter->IncrementOverlappedItemCount(1);
-		}
+		Proximity->UnregisterItem(this);
+	}
+	if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>())
+	{
+		Significance->UnregisterActor(this);
 	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void AItem::OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+float AItem::GetPickupRadius() const
 {
-	if (OtherActor)
-	{
-		AMain* MainCharacter = Cast<AMain>(OtherActor);
-		if (MainCharacter)
-		{
-			MainCharacter->IncrementOverlappedItemCount(-1);
-			MainCharacter->UnHighlightInventorySlot();
-		}
-	}
+	return AreaSphere->GetScaledSphereRadius();
 }
 
 void AItem::SetActiveStars()
 {
 	//the 0 element isn't used
-	for (int32 i = 0; i <= 5; i++)
-	{
-		ActiveStars.Add(false);
-	}
+	ActiveStars.Init(false, 6);
 
 	switch (ItemRarity)
 	{
@@ -119,6 +314,73 @@ void AItem::SetActiveStars()
 }
 
 void AItem::SetItemProperties(EItemState State)
+{
+	//only items lying in the world can be found by the player
+	if (UItemProximitySubsystem* Proximity = GetWorld() ? GetWorld()->GetSubsystem<UItemProximitySubsystem>() : nullptr)
+	{
+		if (State == EItemState::EIS_Pickup)
+		{
+			Proximity->RegisterItem(this);
+		}
+		else
+		{
+			Proximity->UnregisterItem(this);
+		}
+	}
+
+	//loose items get throttled with distance, carried ones stay at full rate
+	if (USignificanceSubsystem* Significance = GetWorld() ? GetWorld()->GetSubsystem<USignificanceSubsystem>() : nullptr)
+	{
+		if (State == EItemState::EIS_Pickup)
+		{
+			Significance->RegisterActor(this);
+		}
+		else
+		{
+			Significance->UnregisterActor(this);
+		}
+	}
+
+	if (CVarBakedItemStateProfiles.GetValueOnGameThread() == 0)
+	{
+		SetItemPropertiesLegacy(State);
+		return;
+	}
+
+	const FItemStateProfile& Profile = GetItemStateProfile(State);
+
+	if (Profile.bHidePickupWidget)
+	{
+		SetPickupWidgetVisible(false);
+	}
+
+	//set mesh properties
+	if (ItemMesh->IsSimulatingPhysics() != Profile.bSimulatePhysics)
+	{
+		ItemMesh->SetSimulatePhysics(Profile.bSimulatePhysics);
+	}
+	if (ItemMesh->IsGravityEnabled() != Profile.bSimulatePhysics)
+	{
+		ItemMesh->SetEnableGravity(Profile.bSimulatePhysics);
+	}
+	ItemMesh->SetVisibility(Profile.bMeshVisible);
+	ApplyComponentCollision(ItemMesh, Profile.Mesh);
+	//set areasphere property
+	ApplyComponentCollision(AreaSphere, Profile.AreaSphere);
+	//set collision properties
+	ApplyComponentCollision(CollisionBox, Profile.CollisionBox);
+}
+
+void AItem::SetPickupWidgetVisible(bool bVisible)
+{
+	if (PickupWidget == nullptr) return;
+
+	PickupWidget->SetVisibility(bVisible);
+	//a screen space widget is added to the viewport from its tick, so it only needs to tick while shown
+	PickupWidget->SetComponentTickEnabled(bVisible);
+}
+
+void AItem::SetItemPropertiesLegacy(EItemState State)
 {
 	switch (State)
 	{
@@ -129,9 +391,9 @@ void AItem::SetItemProperties(EItemState State)
 		ItemMesh->SetVisibility(true);
 		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		//set areasphere property
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Overlap);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+		//set areasphere property, its radius is all the proximity registry needs
+		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 		//set collision properties
 		CollisionBox->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 		CollisionBox->SetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block);
@@ -139,7 +401,7 @@ void AItem::SetItemProperties(EItemState State)
 		break;
 
 	case EItemState::EIS_Equipped:
-		PickupWidget->SetVisibility(false);
+		SetPickupWidgetVisible(false);
 		//set mesh properties
 		ItemMesh->SetSimulatePhysics(false);
 		ItemMesh->SetEnableGravity(false);
@@ -171,7 +433,7 @@ void AItem::SetItemProperties(EItemState State)
 		break;
 
 	case EItemState::EIS_EquipInterping:
-		PickupWidget->SetVisibility(false);
+		SetPickupWidgetVisible(false);
 		//set mesh properties
 		ItemMesh->SetSimulatePhysics(false);
 		ItemMesh->SetEnableGravity(false);
@@ -187,7 +449,7 @@ void AItem::SetItemProperties(EItemState State)
 		break;
 
 	case EItemState::EIS_PickedUp:
-		PickupWidget->SetVisibility(false);
+		SetPickupWidgetVisible(false);
 		//set mesh properties
 		ItemMesh->SetSimulatePhysics(false);
 		ItemMesh->SetEnableGravity(false);
@@ -217,100 +479,30 @@ void AItem::FInishInterping()
 	SetActorScale3D(FVector(1.f));
 }
 
-void AItem::ItemInterp(float DeltaTime)
+void AItem::OnConstruction(const FTransform& Transform)
 {
-	if (!bInterping) return;
-
-	if (Main && ItemZCurve)
-	{
-		//elapsed time since we started iteminterptimer
-		const float ElapsedTime = GetWorldTimerManager().GetTimerElapsed(ItemInterpTimer);
-		//get curve value corresponding to elapsed time
-		const float CurvedValue = ItemZCurve->GetFloatValue(ElapsedTime);
-		//get the item initaill location ehrn curve started
-		FVector ItemLocation = ItemInterpStartLocation;
-		//get location infront of the camera
-		const FVector CameraInterpLocation{ Main->GetCameraInterpLocation() };
-		//vector from item to camera interp location, with only z component
-		const FVector ItemToCamera{ FVector(0.f, 0.f, (CameraInterpLocation - ItemLocation).Z) };
-		//scale factor to be multiplied with the curve value
-		const float DeltaZ = ItemToCamera.Size();
-
-		const FVector CurrentLocation{ GetActorLocation() };
-		//interpolated X value
-		const float InterpXValue = FMath::FInterpTo(CurrentLocation.X, CameraInterpLocation.X, DeltaTime, 30.f);
-		//interpolated Y value
-		const float InterpYValue = FMath::FInterpTo(CurrentLocation.Y, CameraInterpLocation.Y, DeltaTime, 30.f);
-
-		//set X and Y of itemlocation to interped values
-		ItemLocation.X = InterpXValue;
-		ItemLocation.Y = InterpYValue;
-
-		//adding curve value to the z component of the initial location which is scaled by deltaZ
-		ItemLocation.Z += CurvedValue * DeltaZ;
-		SetActorLocation(ItemLocation, true, nullptr, ETeleportType::TeleportPhysics);
-
-		//camera rotation in the current frame
-		const FRotator CameraRotation{ Main->GetFollowCamera()->GetComponentRotation() };
-		//camera rotation plus initialYawOffset
-		FRotator ItemRotation{ 0.f, CameraRotation.Yaw + InterpInitialYawOffset, 0.f };
-		SetActorRotation(ItemRotation, ETeleportType::TeleportPhysics);
-
-		if(ItemScaleCurve)
-		{ 
-			const float ScaleCurveValue = ItemScaleCurve->GetFloatValue(ElapsedTime);
-			SetActorScale3D(FVector(ScaleCurveValue, ScaleCurveValue, ScaleCurveValue));
-		}
-	}
-
+	ApplyRarityData();
 }
 
-void AItem::OnConstruction(const FTransform& Transform)
+void AItem::ApplyRarityData()
 {
-	//load the data in the item rarity data table
-	//path to the item rarity data table
-	FString RarityTablePath(TEXT("DataTable'/Game/Assets/DataTable/ItemRarityDataTable.ItemRarityDataTable'"));
-	UDataTable* RarityTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *RarityTablePath));
-	if (RarityTableObject)
+	//rows come from the registry loaded once per game instance
+	const FItemRarityTable* RarityRow = UGameplayDataSubsystem::GetRegistry(this).GetRarityData(ItemRarity);
+	if (RarityRow)
 	{
-		FItemRarityTable* RarityRow = nullptr;
-		switch (ItemRarity)
-		{
-		case EItemRarity::EIR_Damaged:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Damaged"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Common:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Common"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Uncommon:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Uncommon"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Rare:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Rare"), TEXT(""));
-			break;
-		case EItemRarity::EIR_Legendary:
-			RarityRow = RarityTableObject->FindRow<FItemRarityTable>(FName("Legendary"), TEXT(""));
-			break;
-		}
-
-		if (RarityRow)
-		{
-			LightColor = RarityRow->LightColor;
-			DarkColor = RarityRow->DarkColor;
-			NumberOfStars = RarityRow->NumberOfStars;
-			IconBackground = RarityRow->IconBackground;
-		}
+		LightColor = RarityRow->LightColor;
+		DarkColor = RarityRow->DarkColor;
+		NumberOfStars = RarityRow->NumberOfStars;
 	}
+
+	//the registry streams the backgrounds in on startup, runs right away once they are resident
+	UGameplayDataSubsystem::GetRegistry(this).RequestRarityAssets(FSimpleDelegate::CreateUObject(this, &AItem::ApplyRarityIcon));
 }
 
-// Called every frame
-void AItem::Tick(float DeltaTime)
+void AItem::ApplyRarityIcon()
 {
-	Super::Tick(DeltaTime);
-
-	//handle item interping when in the equipinterping state
-	ItemInterp(DeltaTime);
-
+	const FItemRarityTable* RarityRow = UGameplayDataSubsystem::GetRegistry(this).GetRarityData(ItemRarity);
+	IconBackground = RarityRow ? RarityRow->IconBackground.Get() : nullptr;
 }
 
 void AItem::SetItemState(EItemState State)
@@ -319,6 +511,13 @@ void AItem::SetItemState(EItemState State)
 	SetItemProperties(State);
 }
 
+void AItem::SetItemRarity(EItemRarity Rarity)
+{
+	ItemRarity = Rarity;
+	ApplyRarityData();
+	SetActiveStars();
+}
+
 void AItem::StartItemCurve(AMain* Character)
 {
 	//store the character
@@ -329,14 +528,22 @@ void AItem::StartItemCurve(AMain* Character)
 	bInterping = true;
 	SetItemState(EItemState::EIS_EquipInterping);
 
-	GetWorldTimerManager().SetTimer(ItemInterpTimer, this, &AItem::FInishInterping, ZCurveTime);
-
 	//initial yaw of the camera
 	const float CameraRotationYaw{ Main->GetFollowCamera()->GetComponentRotation().Yaw };
 	//initial yaw of the item
 	const float ItemRotationYaw{ GetActorRotation().Yaw };
 	//initial yaw offset between camera and item
 	InterpInitialYawOffset = ItemRotationYaw - CameraRotationYaw;
+
+	//the subsystem moves the item every frame and calls FInishInterping when the curve is done
+	if (UItemInterpSubsystem* ItemInterp = GetWorld()->GetSubsystem<UItemInterpSubsystem>())
+	{
+		ItemInterp->StartInterp(this, Main, InterpInitialYawOffset);
+	}
+	else
+	{
+		FInishInterping();
+	}
 }
 
 
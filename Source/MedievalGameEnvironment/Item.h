@@ -46,7 +46,7 @@ struct FItemRarityTable : public FTableRowBase
 	int32 NumberOfStars;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* IconBackground;
+	TSoftObjectPtr<UTexture2D> IconBackground;
 
 };
 
@@ -63,15 +63,7 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	//called when overlapping areasphere
-	UFUNCTION()
-	void OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, 
-		int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-
-	//called when end overlapping areasphere
-	UFUNCTION()
-	void OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex);
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	/** Sets the ActiveStars array of bools based on rarity */
 	void SetActiveStars();
@@ -79,17 +71,16 @@ protected:
 	/** Sets properties of the Item's components based on State */
 	void SetItemProperties(EItemState State);
 
-	//called when ItemInterpTimer is finished
-	void FInishInterping();
-
-	//handles item interpolation when in the equipinterping state
-	void ItemInterp(float DeltaTime);
+	//previous per-call version of SetItemProperties, kept for Item.BakedStateProfiles 0
+	void SetItemPropertiesLegacy(EItemState State);
 
 	virtual void OnConstruction(const FTransform& Transform) override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	//copies colors, stars and icon background for ItemRarity from the gameplay data registry
+	void ApplyRarityData();
+
+	//picks up the icon background once the registry has streamed it in
+	void ApplyRarityIcon();
 
 private:
 
@@ -101,11 +92,11 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	class UBoxComponent* CollisionBox;
 
-	//popup widget when the player looks at the item
+	//popup widget when the player looks at the item, only ticks while it is shown
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	class UWidgetComponent* PickupWidget;
 
-	//enables item tracing when overlapped
+	//radius in which the player can trace for the item, has no collision
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	class USphereComponent* AreaSphere;
 
@@ -144,9 +135,6 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	bool bInterping;
 
-	//plays when we start interping 
-	FTimerHandle ItemInterpTimer;
-
 	//duration of the curve and timer
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
 	float ZCurveTime;
@@ -216,7 +204,13 @@ private:
 
 public:
 	FORCEINLINE UWidgetComponent* GetPickupWidget() const {return PickupWidget;}
+
+	//shows or hides the pickup widget and turns its tick on or off with it
+	void SetPickupWidgetVisible(bool bVisible);
 	FORCEINLINE USphereComponent* GetAreaSphere() const { return AreaSphere; }
+
+	//scaled AreaSphere radius
+	float GetPickupRadius() const;
 	FORCEINLINE UBoxComponent* GetCollisionBox() const { return CollisionBox; }
 	FORCEINLINE EItemState GetItemState() const { return ItemState; }
 	void SetItemState(EItemState State);
@@ -229,9 +223,22 @@ public:
 	FORCEINLINE void SetSlotIndex(int32 Index) { SlotIndex = Index; }
 	FORCEINLINE void SetCharacterInventoryFull(bool bFull) { bCharacterInventoryFull = bFull; }
 	FORCEINLINE void SetItemName(FString Name) { ItemName = Name; }
+	FORCEINLINE UTexture2D* GetItemIcon() const { return ItemIcon; }
 	FORCEINLINE void SetItemIcon(UTexture2D* Icon) { ItemIcon = Icon; }
+	FORCEINLINE UTexture2D* GetAmmoIcon() const { return AmmoIcon; }
 	FORCEINLINE void SetAmmoIcon(UTexture2D* Icon) { AmmoIcon = Icon; }
+	FORCEINLINE EItemRarity GetItemRarity() const { return ItemRarity; }
+
+	//changes rarity and refreshes the rarity data and stars
+	void SetItemRarity(EItemRarity Rarity);
 
 	//called from the AMain class
 	void StartItemCurve(AMain* Character);
+
+	//called by UItemInterpSubsystem when the item has reached the camera
+	void FInishInterping();
+
+	FORCEINLINE UCurveFloat* GetItemZCurve() const { return ItemZCurve; }
+	FORCEINLINE UCurveFloat* GetItemScaleCurve() const { return ItemScaleCurve; }
+	FORCEINLINE float GetZCurveTime() const { return ZCurveTime; }
 };
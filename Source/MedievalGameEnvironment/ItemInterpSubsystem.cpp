@@ -0,0 +1,132 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "ItemInterpSubsystem.h"
+#include "Item.h"
+#include "Main.h"
+#include "Camera/CameraComponent.h"
+#include "Curves/CurveFloat.h"
+
+void UItemInterpSubsystem::StartInterp(AItem* Item, AMain* Character, float YawOffset)
+{
+	if (Item == nullptr || Character == nullptr) return;
+
+	//restarting an item that is already flying
+	StopInterp(Item);
+
+	Items.Add(Item);
+	Characters.Add(Character);
+	ZCurves.Add(Item->GetItemZCurve());
+	ScaleCurves.Add(Item->GetItemScaleCurve());
+	StartLocations.Add(Item->GetActorLocation());
+	CurrentLocations.Add(Item->GetActorLocation());
+	ElapsedTimes.Add(0.f);
+	Durations.Add(Item->GetZCurveTime());
+	YawOffsets.Add(YawOffset);
+}
+
+void UItemInterpSubsystem::StopInterp(AItem* Item)
+{
+	const int32 Index{ Items.Find(Item) };
+	if (Index != INDEX_NONE)
+	{
+		RemoveAtSwap(Index);
+	}
+}
+
+void UItemInterpSubsystem::RemoveAtSwap(int32 Index)
+{
+	Items.RemoveAtSwap(Index, 1, false);
+	Characters.RemoveAtSwap(Index, 1, false);
+	ZCurves.RemoveAtSwap(Index, 1, false);
+	ScaleCurves.RemoveAtSwap(Index, 1, false);
+	StartLocations.RemoveAtSwap(Index, 1, false);
+	CurrentLocations.RemoveAtSwap(Index, 1, false);
+	ElapsedTimes.RemoveAtSwap(Index, 1, false);
+	Durations.RemoveAtSwap(Index, 1, false);
+	YawOffsets.RemoveAtSwap(Index, 1, false);
+}
+
+void UItemInterpSubsystem::Tick(float DeltaTime)
+{
+	const int32 Num{ Items.Num() };
+
+	//advance time and sample the curves for the whole batch
+	ZCurveValues.SetNumUninitialized(Num, false);
+	ScaleCurveValues.SetNumUninitialized(Num, false);
+	for (int32 i = 0; i < Num; i++)
+	{
+		ElapsedTimes[i] = FMath::Min(ElapsedTimes[i] + DeltaTime, Durations[i]);
+		ZCurveValues[i] = ZCurves[i] ? ZCurves[i]->GetFloatValue(ElapsedTimes[i]) : 0.f;
+		ScaleCurveValues[i] = ScaleCurves[i] ? ScaleCurves[i]->GetFloatValue(ElapsedTimes[i]) : 1.f;
+	}
+
+	//the camera is read once per character, in practice once per frame
+	AMain* CameraCharacter = nullptr;
+	FVector CameraInterpLocation{ FVector::ZeroVector };
+	float CameraYaw{ 0.f };
+
+	FinishedItems.Reset();
+	for (int32 i = Num - 1; i >= 0; i--)
+	{
+		AItem* Item{ Items[i] };
+		AMain* Character{ Characters[i] };
+		if (Item == nullptr || Item->IsPendingKill() || Character == nullptr || Character->IsPendingKill())
+		{
+			RemoveAtSwap(i);
+			continue;
+		}
+
+		if (Character != CameraCharacter)
+		{
+			CameraCharacter = Character;
+			CameraInterpLocation = Character->GetCameraInterpLocation();
+			CameraYaw = Character->GetFollowCamera()->GetComponentRotation().Yaw;
+		}
+
+		//z follows the curve scaled by the height to the camera, x and y ease towards the camera
+		const FVector& StartLocation = StartLocations[i];
+		const float DeltaZ{ FMath::Abs(CameraInterpLocation.Z - StartLocation.Z) };
+		FVector& ItemLocation = CurrentLocations[i];
+		ItemLocation.X = FMath::FInterpTo(ItemLocation.X, CameraInterpLocation.X, DeltaTime, 30.f);
+		ItemLocation.Y = FMath::FInterpTo(ItemLocation.Y, CameraInterpLocation.Y, DeltaTime, 30.f);
+		ItemLocation.Z = StartLocation.Z + ZCurveValues[i] * DeltaZ;
+
+		const FRotator ItemRotation{ 0.f, CameraYaw + YawOffsets[i], 0.f };
+		const float Scale{ ScaleCurveValues[i] };
+		Item->SetActorTransform(FTransform(ItemRotation, ItemLocation, FVector(Scale)), false, nullptr, ETeleportType::TeleportPhysics);
+
+		if (ElapsedTimes[i] >= Durations[i])
+		{
+			FinishedItems.Add(Item);
+			RemoveAtSwap(i);
+		}
+	}
+
+	//finishing hands the item to the inventory, which may start or stop other interpolations
+	for (AItem* Item : FinishedItems)
+	{
+		Item->FInishInterping();
+	}
+	FinishedItems.Reset();
+}
+
+bool UItemInterpSubsystem::IsTickable() const
+{
+	return Items.Num() > 0;
+}
+
+ETickableTickType UItemInterpSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UItemInterpSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UItemInterpSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemInterpSubsystem, STATGROUP_Tickables);
+}
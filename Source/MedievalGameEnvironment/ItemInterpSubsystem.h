@@ -0,0 +1,65 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ItemInterpSubsystem.generated.h"
+
+class AItem;
+class AMain;
+class UCurveFloat;
+
+/**
+ * Moves every item that is flying from the ground to the camera after being picked up.
+ * Items don't tick; in-flight interpolations are kept in parallel arrays and updated together once per frame.
+ */
+UCLASS()
+class MEDIEVALGAMEENVIRONMENT_API UItemInterpSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	//starts flying the item towards the character's camera interp location
+	void StartInterp(AItem* Item, AMain* Character, float YawOffset);
+
+	//drops the item from the batch without finishing the pickup
+	void StopInterp(AItem* Item);
+
+	FORCEINLINE int32 GetNumInterping() const { return Items.Num(); }
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	void RemoveAtSwap(int32 Index);
+
+	//one entry per in-flight item, every array has the same length
+	UPROPERTY(Transient)
+	TArray<AItem*> Items;
+
+	UPROPERTY(Transient)
+	TArray<AMain*> Characters;
+
+	UPROPERTY(Transient)
+	TArray<UCurveFloat*> ZCurves;
+
+	UPROPERTY(Transient)
+	TArray<UCurveFloat*> ScaleCurves;
+
+	TArray<FVector> StartLocations;
+	TArray<FVector> CurrentLocations;
+	TArray<float> ElapsedTimes;
+	TArray<float> Durations;
+	TArray<float> YawOffsets;
+
+	//per-frame scratch buffers, kept to reuse the allocations
+	TArray<float> ZCurveValues;
+	TArray<float> ScaleCurveValues;
+	TArray<AItem*> FinishedItems;
+};
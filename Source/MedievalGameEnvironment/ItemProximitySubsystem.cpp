@@ -0,0 +1,77 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "ItemProximitySubsystem.h"
+#include "Item.h"
+
+UItemProximitySubsystem::UItemProximitySubsystem() : CellSize(500.f), MaxItemRadius(0.f), Revision(0)
+{
+}
+
+void UItemProximitySubsystem::RegisterItem(AItem* Item)
+{
+	if (Item == nullptr) return;
+
+	const FIntPoint Cell{ GetCell(Item->GetActorLocation()) };
+	if (FIntPoint* CurrentCell = ItemCells.Find(Item))
+	{
+		if (*CurrentCell == Cell) return;
+
+		TArray<AItem*>& OldCellItems = Cells.FindChecked(*CurrentCell);
+		OldCellItems.RemoveSingleSwap(Item, false);
+		if (OldCellItems.Num() == 0)
+		{
+			Cells.Remove(*CurrentCell);
+		}
+		*CurrentCell = Cell;
+	}
+	else
+	{
+		ItemCells.Add(Item, Cell);
+	}
+
+	Cells.FindOrAdd(Cell).Add(Item);
+	MaxItemRadius = FMath::Max(MaxItemRadius, Item->GetPickupRadius());
+	Revision++;
+}
+
+void UItemProximitySubsystem::UnregisterItem(AItem* Item)
+{
+	FIntPoint Cell;
+	if (!ItemCells.RemoveAndCopyValue(Item, Cell)) return;
+
+	TArray<AItem*>& CellItems = Cells.FindChecked(Cell);
+	CellItems.RemoveSingleSwap(Item, false);
+	if (CellItems.Num() == 0)
+	{
+		Cells.Remove(Cell);
+	}
+	Revision++;
+}
+
+int32 UItemProximitySubsystem::QueryItems(const FVector& Location, TArray<AItem*>& OutItems) const
+{
+	OutItems.Reset();
+	if (ItemCells.Num() == 0) return 0;
+
+	const FIntPoint MinCell{ GetCell(Location - FVector(MaxItemRadius)) };
+	const FIntPoint MaxCell{ GetCell(Location + FVector(MaxItemRadius)) };
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<AItem*>* CellItems = Cells.Find(FIntPoint(X, Y));
+			if (CellItems == nullptr) continue;
+
+			for (AItem* Item : *CellItems)
+			{
+				const float Radius{ Item->GetPickupRadius() };
+				if (FVector::DistSquared(Item->GetActorLocation(), Location) <= Radius * Radius)
+				{
+					OutItems.Add(Item);
+				}
+			}
+		}
+	}
+	return OutItems.Num();
+}
@@ -0,0 +1,52 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ItemProximitySubsystem.generated.h"
+
+class AItem;
+
+/**
+ * Grid of the items that can currently be picked up. Items register while they are in the Pickup state
+ * and the player queries the grid instead of counting AreaSphere overlaps.
+ */
+UCLASS()
+class MEDIEVALGAMEENVIRONMENT_API UItemProximitySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UItemProximitySubsystem();
+
+	//adds the item at its current location, or moves it if it is already registered
+	void RegisterItem(AItem* Item);
+	void UnregisterItem(AItem* Item);
+
+	//items whose pickup radius contains the location, returns how many were found
+	int32 QueryItems(const FVector& Location, TArray<AItem*>& OutItems) const;
+
+	//changes whenever an item is registered, moved or unregistered
+	FORCEINLINE uint32 GetRevision() const { return Revision; }
+	FORCEINLINE int32 GetNumItems() const { return ItemCells.Num(); }
+
+private:
+	FORCEINLINE FIntPoint GetCell(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	}
+
+	//registered items per grid cell
+	TMap<FIntPoint, TArray<AItem*>> Cells;
+
+	//cell each registered item is stored in
+	TMap<AItem*, FIntPoint> ItemCells;
+
+	float CellSize;
+
+	//largest pickup radius of any item registered so far, decides how many cells a query visits
+	float MaxItemRadius;
+
+	uint32 Revision;
+};
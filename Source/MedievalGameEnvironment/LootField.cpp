@@ -0,0 +1,354 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "LootField.h"
+#include "Weapon.h"
+#include "WeaponPoolSubsystem.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+
+ALootField::ALootField() : PromoteRadius(600.f), DemoteRadius(1200.f), CellSize(1000.f), NumIdleRecords(0), bInstancesDirty(false)
+{
+	PrimaryActorTick.bCanEverTick = true;
+	//a few promotion checks per second are enough at walking speed
+	PrimaryActorTick.TickInterval = 0.1f;
+
+	SetRootComponent(CreateDefaultSubobject<USceneComponent>(TEXT("Root")));
+
+	for (int32 TypeIndex = 0; TypeIndex < static_cast<int32>(EWeaponType::EWT_MAX); TypeIndex++)
+	{
+		UHierarchicalInstancedStaticMeshComponent* Mesh = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(
+			*FString::Printf(TEXT("LootMesh%d"), TypeIndex));
+		Mesh->SetupAttachment(GetRootComponent());
+		//instances are only drawn, pickups within reach are promoted to actors before they can be traced
+		Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Mesh->SetGenerateOverlapEvents(false);
+		MeshComponents.Add(Mesh);
+	}
+
+#if WITH_EDITORONLY_DATA
+	ScatterCount = 10000;
+	ScatterExtent = FVector(20000.f, 20000.f, 0.f);
+#endif
+}
+
+void ALootField::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	RebuildInstances();
+}
+
+void ALootField::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//runtime records and the grid aren't saved with the level
+	RebuildInstances();
+
+	//the item trace only runs for weapons whose pickup radius the player is in, those have to be actors by then
+	if (WeaponClass)
+	{
+		PromoteRadius = FMath::Max(PromoteRadius, WeaponClass->GetDefaultObject<AWeapon>()->GetPickupRadius());
+		DemoteRadius = FMath::Max(DemoteRadius, PromoteRadius * 2.f);
+	}
+}
+
+ALootField* ALootField::Find(UWorld* World)
+{
+	if (World == nullptr) return nullptr;
+
+	TActorIterator<ALootField> It(World);
+	return It ? *It : nullptr;
+}
+
+UHierarchicalInstancedStaticMeshComponent* ALootField::GetMeshComponent(EWeaponType WeaponType) const
+{
+	const int32 TypeIndex{ static_cast<int32>(WeaponType) };
+	if (!MeshComponents.IsValidIndex(TypeIndex) || MeshComponents[TypeIndex] == nullptr) return nullptr;
+
+	return MeshComponents[TypeIndex]->GetStaticMesh() ? MeshComponents[TypeIndex] : nullptr;
+}
+
+void ALootField::RebuildInstances()
+{
+	const int32 NumTypes{ static_cast<int32>(EWeaponType::EWT_MAX) };
+	for (int32 TypeIndex = 0; TypeIndex < NumTypes && TypeIndex < MeshComponents.Num(); TypeIndex++)
+	{
+		if (MeshComponents[TypeIndex])
+		{
+			MeshComponents[TypeIndex]->ClearInstances();
+			MeshComponents[TypeIndex]->SetStaticMesh(ProxyMeshes.IsValidIndex(TypeIndex) ? ProxyMeshes[TypeIndex] : nullptr);
+		}
+	}
+
+	Records = Loot;
+	RecordInstances.Init(INDEX_NONE, Records.Num());
+	FreeRecords.Reset();
+	Cells.Reset();
+	NumIdleRecords = 0;
+	MeshInstances.Reset();
+	MeshInstances.SetNum(NumTypes);
+
+	//instances are added per mesh in one call
+	TArray<TArray<FTransform>> InstanceTransforms;
+	InstanceTransforms.SetNum(NumTypes);
+	for (int32 RecordIndex = 0; RecordIndex < Records.Num(); RecordIndex++)
+	{
+		const FLootRecord& Record = Records[RecordIndex];
+		UHierarchicalInstancedStaticMeshComponent* Mesh = GetMeshComponent(Record.WeaponType);
+		if (Mesh == nullptr)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: no proxy mesh for weapon type %d, loot %d is skipped"),
+				*GetName(), static_cast<int32>(Record.WeaponType), RecordIndex);
+			FreeRecords.Add(RecordIndex);
+			continue;
+		}
+
+		const int32 TypeIndex{ static_cast<int32>(Record.WeaponType) };
+		RecordInstances[RecordIndex] = MeshInstances[TypeIndex].InstanceRecords.Add(RecordIndex);
+		InstanceTransforms[TypeIndex].Add(Record.Transform.GetRelativeTransform(Mesh->GetComponentTransform()));
+		Cells.FindOrAdd(GetCell(Record.Transform.GetLocation())).Add(RecordIndex);
+		NumIdleRecords++;
+	}
+
+	for (int32 TypeIndex = 0; TypeIndex < NumTypes; TypeIndex++)
+	{
+		if (InstanceTransforms[TypeIndex].Num() > 0)
+		{
+			MeshComponents[TypeIndex]->AddInstances(InstanceTransforms[TypeIndex], false);
+		}
+	}
+}
+
+int32 ALootField::AddLoot(const FLootRecord& Record)
+{
+	UHierarchicalInstancedStaticMeshComponent* Mesh = GetMeshComponent(Record.WeaponType);
+	if (Mesh == nullptr) return INDEX_NONE;
+
+	const int32 RecordIndex{ FreeRecords.Num() > 0 ? FreeRecords.Pop(false) : Records.AddDefaulted() };
+	RecordInstances.SetNum(Records.Num());
+	Records[RecordIndex] = Record;
+	RecordInstances[RecordIndex] = AddInstance(RecordIndex);
+	Cells.FindOrAdd(GetCell(Record.Transform.GetLocation())).Add(RecordIndex);
+	NumIdleRecords++;
+	return RecordIndex;
+}
+
+int32 ALootField::AddInstance(int32 RecordIndex)
+{
+	const FLootRecord& Record = Records[RecordIndex];
+	UHierarchicalInstancedStaticMeshComponent* Mesh = GetMeshComponent(Record.WeaponType);
+	FLootMeshInstances& Instances = MeshInstances[static_cast<int32>(Record.WeaponType)];
+
+	int32 InstanceIndex{ INDEX_NONE };
+	if (Instances.FreeInstances.Num() > 0)
+	{
+		//reuse a hidden instance rather than growing the component
+		InstanceIndex = Instances.FreeInstances.Pop(false);
+		Mesh->UpdateInstanceTransform(InstanceIndex, Record.Transform, true, false, true);
+		Instances.InstanceRecords[InstanceIndex] = RecordIndex;
+	}
+	else
+	{
+		InstanceIndex = Mesh->AddInstanceWorldSpace(Record.Transform);
+		Instances.InstanceRecords.SetNum(FMath::Max(Instances.InstanceRecords.Num(), InstanceIndex + 1));
+		Instances.InstanceRecords[InstanceIndex] = RecordIndex;
+	}
+	bInstancesDirty = true;
+	return InstanceIndex;
+}
+
+void ALootField::HideInstance(int32 RecordIndex)
+{
+	const int32 InstanceIndex{ RecordInstances[RecordIndex] };
+	if (InstanceIndex == INDEX_NONE) return;
+
+	const FLootRecord& Record = Records[RecordIndex];
+	UHierarchicalInstancedStaticMeshComponent* Mesh = GetMeshComponent(Record.WeaponType);
+	FLootMeshInstances& Instances = MeshInstances[static_cast<int32>(Record.WeaponType)];
+
+	//removing would reorder the instances, a zero scale hides it and drops its collision body
+	const FTransform HiddenTransform{ FQuat::Identity, Record.Transform.GetLocation(), FVector::ZeroVector };
+	Mesh->UpdateInstanceTransform(InstanceIndex, HiddenTransform, true, false, true);
+	Instances.InstanceRecords[InstanceIndex] = INDEX_NONE;
+	Instances.FreeInstances.Add(InstanceIndex);
+	RecordInstances[RecordIndex] = INDEX_NONE;
+	bInstancesDirty = true;
+}
+
+AWeapon* ALootField::PromoteRecord(int32 RecordIndex)
+{
+	if (!RecordInstances.IsValidIndex(RecordIndex) || RecordInstances[RecordIndex] == INDEX_NONE) return nullptr;
+
+	UWeaponPoolSubsystem* WeaponPool = GetWorld()->GetSubsystem<UWeaponPoolSubsystem>();
+	if (WeaponPool == nullptr || WeaponClass == nullptr) return nullptr;
+
+	const FLootRecord& Record = Records[RecordIndex];
+	AWeapon* Weapon = WeaponPool->AcquireWeapon(WeaponClass, Record.Transform);
+	if (Weapon == nullptr) return nullptr;
+
+	FDehydratedWeapon WeaponData;
+	WeaponData.WeaponClass = WeaponClass;
+	WeaponData.WeaponType = Record.WeaponType;
+	WeaponData.ItemRarity = Record.ItemRarity;
+	WeaponData.Ammo = Record.Ammo;
+	Weapon->Rehydrate(WeaponData);
+	Weapon->SetItemState(EItemState::EIS_Pickup);
+
+	HideInstance(RecordIndex);
+	if (TArray<int32>* Cell = Cells.Find(GetCell(Record.Transform.GetLocation())))
+	{
+		Cell->RemoveSingleSwap(RecordIndex, false);
+	}
+	FreeRecords.Add(RecordIndex);
+	NumIdleRecords--;
+
+	PromotedWeapons.AddUnique(Weapon);
+	return Weapon;
+}
+
+void ALootField::TrackWeapon(AWeapon* Weapon)
+{
+	if (Weapon)
+	{
+		PromotedWeapons.AddUnique(Weapon);
+	}
+}
+
+void ALootField::DemoteWeapon(AWeapon* Weapon)
+{
+	//a record can only bring back the field's weapon class
+	if (Weapon->GetClass() != WeaponClass || GetMeshComponent(Weapon->GetWeaponType()) == nullptr) return;
+
+	const FDehydratedWeapon WeaponData{ Weapon->Dehydrate() };
+	FLootRecord Record;
+	Record.WeaponType = WeaponData.WeaponType;
+	Record.ItemRarity = WeaponData.ItemRarity;
+	Record.Ammo = WeaponData.Ammo;
+	Record.Transform = FTransform(Weapon->GetActorRotation(), Weapon->GetActorLocation());
+
+	if (AddLoot(Record) == INDEX_NONE) return;
+
+	PromotedWeapons.RemoveSingleSwap(Weapon, false);
+	if (UWeaponPoolSubsystem* WeaponPool = GetWorld()->GetSubsystem<UWeaponPoolSubsystem>())
+	{
+		WeaponPool->ReleaseWeapon(Weapon);
+	}
+	else
+	{
+		Weapon->Destroy();
+	}
+}
+
+void ALootField::UpdatePromotedWeapons(const FVector& Location)
+{
+	const float DemoteRadiusSquared{ DemoteRadius * DemoteRadius };
+	for (int32 i = PromotedWeapons.Num() - 1; i >= 0; i--)
+	{
+		AWeapon* Weapon{ PromotedWeapons[i] };
+		if (Weapon == nullptr || Weapon->IsPendingKill())
+		{
+			PromotedWeapons.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		const EItemState ItemState{ Weapon->GetItemState() };
+		//still settling
+		if (ItemState == EItemState::EIS_Falling) continue;
+
+		if (ItemState != EItemState::EIS_Pickup)
+		{
+			//picked up, the inventory owns it now
+			PromotedWeapons.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		if (FVector::DistSquared(Weapon->GetActorLocation(), Location) > DemoteRadiusSquared)
+		{
+			DemoteWeapon(Weapon);
+		}
+	}
+}
+
+void ALootField::PromoteAround(const FVector& Location)
+{
+	if (NumIdleRecords == 0) return;
+
+	const FIntPoint MinCell{ GetCell(Location - FVector(PromoteRadius)) };
+	const FIntPoint MaxCell{ GetCell(Location + FVector(PromoteRadius)) };
+	const float PromoteRadiusSquared{ PromoteRadius * PromoteRadius };
+
+	//collected first, promoting edits the cells
+	TArray<int32, TInlineAllocator<16>> Candidates;
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<int32>* Cell = Cells.Find(FIntPoint(X, Y));
+			if (Cell == nullptr) continue;
+
+			for (const int32 RecordIndex : *Cell)
+			{
+				if (FVector::DistSquared(Records[RecordIndex].Transform.GetLocation(), Location) <= PromoteRadiusSquared)
+				{
+					Candidates.Add(RecordIndex);
+				}
+			}
+		}
+	}
+
+	for (const int32 RecordIndex : Candidates)
+	{
+		PromoteRecord(RecordIndex);
+	}
+}
+
+void ALootField::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+	if (Player)
+	{
+		//demote before promoting, DemoteRadius is larger so nothing flips back and forth
+		const FVector PlayerLocation{ Player->GetActorLocation() };
+		UpdatePromotedWeapons(PlayerLocation);
+		PromoteAround(PlayerLocation);
+	}
+
+	if (bInstancesDirty)
+	{
+		for (UHierarchicalInstancedStaticMeshComponent* Mesh : MeshComponents)
+		{
+			if (Mesh)
+			{
+				Mesh->MarkRenderStateDirty();
+			}
+		}
+		bInstancesDirty = false;
+	}
+}
+
+#if WITH_EDITOR
+void ALootField::ScatterLoot()
+{
+	Modify();
+
+	FRandomStream Random(ScatterCount);
+	Loot.Reset(ScatterCount);
+	for (int32 i = 0; i < ScatterCount; i++)
+	{
+		FLootRecord& Record = Loot.AddDefaulted_GetRef();
+		Record.WeaponType = static_cast<EWeaponType>(Random.RandRange(0, static_cast<int32>(EWeaponType::EWT_MAX) - 1));
+		Record.ItemRarity = static_cast<EItemRarity>(Random.RandRange(0, static_cast<int32>(EItemRarity::EIR_MAX) - 1));
+		const FVector Offset{ Random.FRandRange(-ScatterExtent.X, ScatterExtent.X), Random.FRandRange(-ScatterExtent.Y, ScatterExtent.Y),
+			Random.FRandRange(-ScatterExtent.Z, ScatterExtent.Z) };
+		Record.Transform = FTransform(FRotator(0.f, Random.FRandRange(0.f, 360.f), 0.f), GetActorLocation() + Offset);
+	}
+
+	RebuildInstances();
+}
+#endif
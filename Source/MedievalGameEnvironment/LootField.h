@@ -0,0 +1,159 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Item.h"
+#include "WeaponType.h"
+#include "LootField.generated.h"
+
+class AWeapon;
+class UStaticMesh;
+class UHierarchicalInstancedStaticMeshComponent;
+
+//one idle weapon lying in the world without an actor
+USTRUCT(BlueprintType)
+struct FLootRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EWeaponType WeaponType = EWeaponType::EWT_Snipper;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EItemRarity ItemRarity = EItemRarity::EIR_Common;
+
+	//ammo in the magazine, -1 keeps the weapon table default
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Ammo = -1;
+
+	//world transform of the pickup
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FTransform Transform;
+};
+
+//instance bookkeeping of one proxy mesh component
+struct FLootMeshInstances
+{
+	//record shown by each instance, INDEX_NONE for hidden instances
+	TArray<int32> InstanceRecords;
+
+	//hidden instances that can be reused
+	TArray<int32> FreeInstances;
+};
+
+/**
+ * Renders idle weapon pickups as instances of one hierarchical instanced static mesh per weapon type.
+ * A pickup becomes a real AWeapon (taken from the weapon pool) when the player gets within its pickup radius,
+ * and goes back to being an instance once it lies untouched far enough from the player.
+ */
+UCLASS()
+class MEDIEVALGAMEENVIRONMENT_API ALootField : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ALootField();
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+	virtual void Tick(float DeltaTime) override;
+
+	//the loot field of the world, nullptr if the level has none
+	static ALootField* Find(UWorld* World);
+
+	//adds an idle pickup, returns its record index
+	UFUNCTION(BlueprintCallable, Category = Loot)
+	int32 AddLoot(const FLootRecord& Record);
+
+	//starts watching a dropped weapon so it can be turned back into an instance once it settles
+	void TrackWeapon(AWeapon* Weapon);
+
+	FORCEINLINE int32 GetNumIdleLoot() const { return NumIdleRecords; }
+	FORCEINLINE int32 GetNumPromoted() const { return PromotedWeapons.Num(); }
+
+#if WITH_EDITOR
+	//fills Loot with random pickups inside ScatterExtent, for testing large fields
+	UFUNCTION(CallInEditor, Category = Loot)
+	void ScatterLoot();
+#endif
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	void RebuildInstances();
+
+	AWeapon* PromoteRecord(int32 RecordIndex);
+	void DemoteWeapon(AWeapon* Weapon);
+
+	//promotes idle records around the location
+	void PromoteAround(const FVector& Location);
+
+	//demotes settled weapons that are far from the location and drops records of picked up weapons
+	void UpdatePromotedWeapons(const FVector& Location);
+
+	int32 AddInstance(int32 RecordIndex);
+	void HideInstance(int32 RecordIndex);
+
+	FORCEINLINE FIntPoint GetCell(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* GetMeshComponent(EWeaponType WeaponType) const;
+
+	//pickups placed in the editor
+	UPROPERTY(EditAnywhere, Category = Loot)
+	TArray<FLootRecord> Loot;
+
+	//static stand-in mesh per weapon type, index is EWeaponType
+	UPROPERTY(EditAnywhere, Category = Loot)
+	TArray<UStaticMesh*> ProxyMeshes;
+
+	//class the promoted weapons are created from
+	UPROPERTY(EditAnywhere, Category = Loot)
+	TSubclassOf<AWeapon> WeaponClass;
+
+	//pickups closer than this to the player become actors, raised to the weapon's pickup radius at BeginPlay
+	UPROPERTY(EditAnywhere, Category = Loot)
+	float PromoteRadius;
+
+	//settled weapons further than this from the player become instances again
+	UPROPERTY(EditAnywhere, Category = Loot)
+	float DemoteRadius;
+
+	//size of the grid cells used to find pickups around the player
+	UPROPERTY(EditAnywhere, Category = Loot)
+	float CellSize;
+
+#if WITH_EDITORONLY_DATA
+	UPROPERTY(EditAnywhere, Category = Loot)
+	int32 ScatterCount;
+
+	UPROPERTY(EditAnywhere, Category = Loot)
+	FVector ScatterExtent;
+#endif
+
+	UPROPERTY(VisibleAnywhere, Category = Loot)
+	TArray<UHierarchicalInstancedStaticMeshComponent*> MeshComponents;
+
+	//weapons that were promoted or dropped and may become instances again
+	UPROPERTY(Transient)
+	TArray<AWeapon*> PromotedWeapons;
+
+	//runtime records, records that are not idle are in FreeRecords
+	TArray<FLootRecord> Records;
+	TArray<int32> RecordInstances;
+	TArray<int32> FreeRecords;
+	int32 NumIdleRecords;
+
+	//idle records per grid cell
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	//instance bookkeeping, index is EWeaponType
+	TArray<FLootMeshInstances> MeshInstances;
+
+	//set when instance transforms changed this frame
+	bool bInstancesDirty;
+};
@@ -19,7 +19,20 @@
 #include "Components/BoxComponent.h"
 #include "Enemy.h"
 #include "EnemyController.h"
-#include "BehaviorTree/BlackboardComponent.h"
+#include "FXPoolSubsystem.h"
+#include "CombatAudioSubsystem.h"
+#include "HitEventSubsystem.h"
+#include "CrosshairSpreadComponent.h"
+#include "ItemProximitySubsystem.h"
+#include "GameplayDataSubsystem.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarAsyncItemTrace(
+	TEXT("Main.AsyncItemTrace"),
+	0,
+	TEXT("0: trace for items synchronously every frame.\n")
+	TEXT("1: issue the item trace asynchronously and use its result one frame later."),
+	ECVF_Default);
 
 // Sets default values
 AMain::AMain(): 
@@ -27,14 +40,9 @@ AMain::AMain():
 	BaseTurnRate(45.f), BaseLookUpRate(45.f), 
 	//true when aiming
 	bAiming(false), 
-	//camera field of view values
-	CameraDefaultFOV(0.f), CameraZoomedFOV(35.f), CameraCurrentFOV(0.f), ZoomInterpSpeed(20.f),
-	//crosshair spread factors
-	CrosshairSpreadMultiplier(0.f),
-	CrosshairVelocityFactor(0.f),
-	CrosshairInAirFactor(0.f),
-	CrosshairAimFactor(0.f),
-	CrosshairShootingFactor(0.f),
+	//projectile fire variables
+	bFireProjectiles(false),
+	BulletProjectileType(INDEX_NONE),
 	//bullet fire timer variables
 	ShootTimeDurartion(0.05f),
 	bFiringWhip(false),
@@ -42,9 +50,15 @@ AMain::AMain():
 	AutomaticFireRate(0.1f),
 	bShouldFire(true),
 	bFireButtonPressed(false),
+	//crosshair trace cache counters
+	CrosshairTraceCacheHits(0),
+	CrosshairTraceCacheMisses(0),
 	//item trace variable
 	bShouldTraceForItems(false),
-	OverlappedItemCount(0),
+	LastProximityLocation(FVector(0.f)),
+	LastProximityRevision(MAX_uint32),
+	ProximityRequeryDistance(50.f),
+	ItemViewConeAngle(60.f),
 	//camera interp location variables
 	CameraInterpDistance(250.f),
 	CameraInterpElevation(65.f),
@@ -55,6 +69,7 @@ AMain::AMain():
 	CombatState(ECombatState::ECS_Unoccupied),
 	//icon animation property
 	HighlightedSlot(-1),
+	PendingEquipSlot(-1),
 	//main character health
 	Health(100.f), MaxHealth(100.f),
 	StunChance(.25f)
@@ -77,6 +92,12 @@ AMain::AMain():
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName);
 	//set our turn rates for input
 
+	//create the inventory slots
+	InventoryComponent = CreateDefaultSubobject<UInventoryComponent>(TEXT("InventoryComponent"));
+
+	//create the camera zoom and crosshair spread component
+	CrosshairSpread = CreateDefaultSubobject<UCrosshairSpreadComponent>(TEXT("CrosshairSpread"));
+
 	//don't rotate the character when the camera controller is rotating, let that just affect the camera
 	bUseControllerRotationPitch = false;
 	bUseControllerRotationRoll = false;
@@ -101,7 +122,7 @@ float AMain::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, ACo
 		auto EnemyController = Cast<AEnemyController>(EventInstigator);
 		if (EnemyController)
 		{
-			EnemyController->GetBlackboardComponent()->SetValueAsBool(FName(TEXT("CharacterDead")), true);
+			EnemyController->SetCharacterDead(true);
 		}
 	}
 	else
@@ -131,9 +152,14 @@ void AMain::SelectButtonPressed()
 	{
 		TraceHitItem->StartItemCurve(this);
 
-		if (TraceHitItem->GetPickupSound())
+		//the popup stays where the item was otherwise
+		HidePickupWidget();
+		TraceHitItemLastFrame = nullptr;
+
+		UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+		if (TraceHitItem->GetPickupSound() && CombatAudio)
 		{
-			UGameplayStatics::PlaySound2D(this, TraceHitItem->GetPickupSound());
+			CombatAudio->PlaySound2D(TraceHitItem->GetPickupSound(), ECombatSoundCategory::ECSC_Interface);
 		}
 
 		TraceHitItem = nullptr;
@@ -146,10 +172,9 @@ void AMain::SelectButtonReleased()
 
 void AMain::SwapWeapon(AWeapon* WeaponToSwap)
 {
-	if (Inventory.Num() - 1 >= EquippedWeapon->GetSlotIndex())
+	if (InventoryComponent->IsValidSlot(EquippedWeapon->GetSlotIndex()))
 	{
-		Inventory[EquippedWeapon->GetSlotIndex()] = WeaponToSwap;
-		WeaponToSwap->SetSlotIndex(EquippedWeapon->GetSlotIndex());
+		InventoryComponent->ReplaceItem(EquippedWeapon->GetSlotIndex(), WeaponToSwap);
 	}
 
 	DropWeapon();
@@ -174,13 +199,14 @@ bool AMain::WeaponHasAmmo()
 void AMain::PlayFireSound()
 {
 	//play fire sound
-	if (FireSound)
+	UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+	if (FireSound && CombatAudio)
 	{
-		UGameplayStatics::PlaySound2D(this, FireSound);
+		CombatAudio->PlaySound2D(FireSound, ECombatSoundCategory::ECSC_WeaponFire);
 	}
 }
 
-void AMain::SendBullet()
+void AMain::SendBullet(const TArray<float>& ShotAges)
 {
 	//send bullet
 	const USkeletalMeshSocket* WhipSocket = EquippedWeapon->GetItemMesh()->GetSocketByName("WhipSocket");
@@ -191,61 +217,88 @@ void AMain::SendBullet()
 		const FTransform SocketTransform = WhipSocket->GetSocketTransform(EquippedWeapon->GetItemMesh());
 		/*const FTransform SocketTransform = WhipSocket->GetSocketTransform(GetMesh());*/
 
-		if (MuzzleFlash)
+		UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+
+		if (MuzzleFlash && FXPool)
 		{
-			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), MuzzleFlash, SocketTransform);
+			FXPool->SpawnEmitter(MuzzleFlash, SocketTransform);
 		}
 
-		FHitResult BeamHitResult;
-		/*FVector BeamEnd;*/
-		bool bBeamEnd = GetBeamEndLocation(SocketTransform.GetLocation(), BeamHitResult);
-		if (bBeamEnd)
+		//projectiles fly toward the crosshair target and deal their damage when their trace hits
+		UProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<UProjectileSubsystem>();
+		if (bFireProjectiles && Projectiles && BulletProjectileType != INDEX_NONE)
 		{
-			//does hit actor implement whiphitinterface?
-			if (BeamHitResult.Actor.IsValid())
+			FHitResult CrosshairHitResult;
+			FVector AimLocation;
+			if (TraceUnderCrossHairs(CrosshairHitResult, AimLocation))
 			{
-				IWhipHitInterface* WhipHitInterface = Cast<IWhipHitInterface>(BeamHitResult.Actor.Get());
-				if (WhipHitInterface)
-				{
-					WhipHitInterface->WhipHit_Implementation(BeamHitResult);
-				}
-				AEnemy* HitEnemy = Cast<AEnemy>(BeamHitResult.Actor.Get());
-				if (HitEnemy)
+				AimLocation = CrosshairHitResult.Location;
+			}
+			for (const float ShotAge : ShotAges)
+			{
+				//the muzzle has moved with the character since the round was due
+				const FVector ShotLocation{ SocketTransform.GetLocation() - GetVelocity() * ShotAge };
+				Projectiles->FireProjectile(BulletProjectileType, ShotLocation, AimLocation - ShotLocation, this, ShotAge);
+			}
+			return;
+		}
+
+		for (const float ShotAge : ShotAges)
+		{
+			//every round traces from where the muzzle was when it fell due
+			const FVector ShotLocation{ SocketTransform.GetLocation() - GetVelocity() * ShotAge };
+			FHitResult BeamHitResult;
+			/*FVector BeamEnd;*/
+			bool bBeamEnd = GetBeamEndLocation(ShotLocation, BeamHitResult);
+			if (bBeamEnd)
+			{
+				//queue the hit; whip hit reactions and damage are dispatched once at the end of the frame
+				if (BeamHitResult.Actor.IsValid())
 				{
-					if (BeamHitResult.BoneName.ToString() == HitEnemy->GetHeadBone())
+					float HitDamage{ 0.f };
+					AEnemy* HitEnemy = Cast<AEnemy>(BeamHitResult.Actor.Get());
+					if (HitEnemy)
 					{
-						//head shot 
-						UGameplayStatics::ApplyDamage(BeamHitResult.Actor.Get(), GetHeadShotDamage(), GetController(), this,
-							UDamageType::StaticClass());
+						HitDamage = GetHitDamage(HitEnemy, BeamHitResult);
+						/*UE_LOG(LogTemp, Warning, TEXT("Hit component: %s"), *BeamHitResult.BoneName.ToString());*/
 					}
-					else
+
+					UHitEventSubsystem* HitEvents = GetWorld()->GetSubsystem<UHitEventSubsystem>();
+					if (HitEvents)
 					{
-						//body shot
-						UGameplayStatics::ApplyDamage(BeamHitResult.Actor.Get(), GetDamage(), GetController(), this,
-							UDamageType::StaticClass());
+						HitEvents->QueueHit(BeamHitResult, HitDamage, GetController(), this);
 					}
-					/*UE_LOG(LogTemp, Warning, TEXT("Hit component: %s"), *BeamHitResult.BoneName.ToString());*/
 				}
-			}
-			else
-			{
-				//spawn default particles
-				if (ImpactParticles)
+				else
 				{
-					UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ImpactParticles, BeamHitResult.Location);
+					//spawn default particles
+					if (ImpactParticles && FXPool)
+					{
+						FXPool->SpawnEmitterAtLocation(ImpactParticles, BeamHitResult.Location);
+					}
 				}
-			}
 
-			UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), BeamParticles, SocketTransform);
-			if (Beam)
-			{
-				Beam->SetVectorParameter(FName("Target"), BeamHitResult.Location);
+				if (BeamParticles && FXPool)
+				{
+					const FTransform BeamTransform{ SocketTransform.GetRotation(), ShotLocation, SocketTransform.GetScale3D() };
+					FXPool->SpawnBeam(BeamParticles, BeamTransform, BeamHitResult.Location);
+				}
 			}
 		}
 
 	}
 }
 
+float AMain::GetHitDamage(const AEnemy* HitEnemy, const FHitResult& HitResult) const
+{
+	float DamageMultiplier{ 1.f };
+	const EHitZone HitZone{ HitEnemy->GetHitZone(HitResult, DamageMultiplier) };
+
+	//head shots start from the headshot damage, every zone is then scaled by its multiplier
+	const float BaseDamage{ HitZone == EHitZone::EHZ_Head ? GetHeadShotDamage() : GetDamage() };
+	return BaseDamage * DamageMultiplier;
+}
+
 void AMain::PlayGunFireMontage()
 {
 	//play gun fire montage
@@ -310,57 +363,46 @@ void AMain::GrabClip()
 	EquippedWeapon->SetMovingClip(true);
 }
 
-void AMain::FKeyPressed()
-{
-	if (EquippedWeapon->GetSlotIndex() == 0) return;
-
-	ExchangeInventoryItems(EquippedWeapon->GetSlotIndex(), 0);
-}
-
-void AMain::OneKeyPressed()
-{
-	if (EquippedWeapon->GetSlotIndex() == 1) return;
-
-	ExchangeInventoryItems(EquippedWeapon->GetSlotIndex(), 1);
-}
-
-void AMain::TwoKeyPressed()
-{
-	if (EquippedWeapon->GetSlotIndex() == 2) return;
-
-	ExchangeInventoryItems(EquippedWeapon->GetSlotIndex(), 2);
-}
-
-void AMain::ThreeKeyPressed()
-{
-	if (EquippedWeapon->GetSlotIndex() == 3) return;
-
-	ExchangeInventoryItems(EquippedWeapon->GetSlotIndex(), 3);
-}
-
-void AMain::FourKeyPressed()
+void AMain::SlotKeyPressed(int32 SlotIndex)
 {
-	if (EquippedWeapon->GetSlotIndex() == 4) return;
+	if (EquippedWeapon == nullptr || EquippedWeapon->GetSlotIndex() == SlotIndex) return;
 
-	ExchangeInventoryItems(EquippedWeapon->GetSlotIndex(), 4);
+	ExchangeInventoryItems(EquippedWeapon->GetSlotIndex(), SlotIndex);
 }
 
-void AMain::FiveKeyPressed()
+void AMain::ExchangeInventoryItems(int32 CurrentItemIndex, int32 NewItemIndex)
 {
-	if (EquippedWeapon->GetSlotIndex() == 5) return;
+	if ((CurrentItemIndex == NewItemIndex) || (CombatState != ECombatState::ECS_Unoccupied)) return;
 
-	ExchangeInventoryItems(EquippedWeapon->GetSlotIndex(), 5);
-}
+	//the weapon can't be shown in hand before its mesh and sounds are streamed in
+	EWeaponType NewWeaponType{ EWeaponType::EWT_MAX };
+	FDehydratedWeapon DehydratedWeapon;
+	if (InventoryComponent->GetDehydratedWeapon(NewItemIndex, DehydratedWeapon))
+	{
+		NewWeaponType = DehydratedWeapon.WeaponType;
+	}
+	else if (const AWeapon* SlotWeapon = Cast<AWeapon>(InventoryComponent->GetItem(NewItemIndex)))
+	{
+		NewWeaponType = SlotWeapon->GetWeaponType();
+	}
+	FGameplayDataRegistry& GameplayData = UGameplayDataSubsystem::GetRegistry(this);
+	if (NewWeaponType != EWeaponType::EWT_MAX && GameplayData.GetWeaponAssetState(NewWeaponType) != EWeaponAssetState::EWAS_Loaded)
+	{
+		PendingEquipSlot = NewItemIndex;
+		GameplayData.RequestWeaponAssets(NewWeaponType, FSimpleDelegate::CreateUObject(this, &AMain::OnPendingEquipAssetsLoaded));
+		return;
+	}
+	PendingEquipSlot = -1;
 
-void AMain::ExchangeInventoryItems(int32 CurrentItemIndex, int32 NewItemIndex)
-{
-	if ((CurrentItemIndex == NewItemIndex) || (NewItemIndex >= Inventory.Num()) || (CombatState != ECombatState::ECS_Unoccupied)) return;
 	auto OldEquippedWeapon = EquippedWeapon;
-	auto NewWeapon = Cast<AWeapon>(Inventory[NewItemIndex]);
+	//the selected weapon only exists as a record until now
+	auto NewWeapon = Cast<AWeapon>(InventoryComponent->RehydrateSlot(NewItemIndex));
+	if (NewWeapon == nullptr) return;
 	EquipWeapon(NewWeapon);
 
 	OldEquippedWeapon->SetItemState(EItemState::EIS_PickedUp);
 	NewWeapon->SetItemState(EItemState::EIS_Equipped);
+	InventoryComponent->DehydrateSlot(CurrentItemIndex);
 
 	CombatState = ECombatState::ECS_Equipping;
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
@@ -372,36 +414,72 @@ void AMain::ExchangeInventoryItems(int32 CurrentItemIndex, int32 NewItemIndex)
 	}
 }
 
-int32 AMain::GetEmptyInventorySlot()
+void AMain::OnPendingEquipAssetsLoaded()
 {
-	for (int32 i = 0; i < Inventory.Num(); i++)
-	{
-		if (Inventory[i] == nullptr)
-		{
-			return i;
-		}
-	}
-	if (Inventory.Num() < INVENTORY_CAPACITY)
-	{
-		return Inventory.Num();
-	}
+	if (PendingEquipSlot == -1 || EquippedWeapon == nullptr) return;
 
-	return -1; //inventory is full
+	const int32 SlotIndex{ PendingEquipSlot };
+	PendingEquipSlot = -1;
+	ExchangeInventoryItems(EquippedWeapon->GetSlotIndex(), SlotIndex);
+}
+
+int32 AMain::GetEmptyInventorySlot()
+{
+	return InventoryComponent->FindEmptySlot(); //-1 if inventory is full
 }
 
 void AMain::HighlightInventorySlot()
 {
 	const int32 EmptySlot{GetEmptyInventorySlot()};
-	HighlightIconDelegate.Broadcast(EmptySlot, true);
+	InventoryComponent->NotifyHighlighted(EmptySlot, true);
 	HighlightedSlot = EmptySlot;
 }
 
 void AMain::UnHighlightInventorySlot()
 {
-	HighlightIconDelegate.Broadcast(HighlightedSlot, false);
+	InventoryComponent->NotifyHighlighted(HighlightedSlot, false);
 	HighlightedSlot = -1;
 }
 
+void AMain::RefreshInventoryItems()
+{
+	int32 NumSlots{ InventoryComponent->GetCapacity() };
+	while (NumSlots > 0 && !InventoryComponent->IsSlotOccupied(NumSlots - 1))
+	{
+		NumSlots--;
+	}
+
+	Inventory.SetNum(NumSlots);
+	for (int32 SlotIndex = 0; SlotIndex < NumSlots; SlotIndex++)
+	{
+		Inventory[SlotIndex] = InventoryComponent->GetItem(SlotIndex);
+	}
+}
+
+void AMain::OnInventorySlotsChanged(const TArray<FInventorySlotEvent>& SlotEvents)
+{
+	//dehydrate and rehydrate don't queue events, but they only happen alongside an add or an equip
+	RefreshInventoryItems();
+
+	for (const FInventorySlotEvent& SlotEvent : SlotEvents)
+	{
+		switch (SlotEvent.Change)
+		{
+		case EInventorySlotChange::EISC_Equipped:
+			EquipItemDelegate.Broadcast(SlotEvent.PreviousSlotIndex, SlotEvent.SlotIndex);
+			break;
+		case EInventorySlotChange::EISC_Highlighted:
+			HighlightIconDelegate.Broadcast(SlotEvent.SlotIndex, true);
+			break;
+		case EInventorySlotChange::EISC_Unhighlighted:
+			HighlightIconDelegate.Broadcast(SlotEvent.SlotIndex, false);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
 void AMain::Die()
 {
 	UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
@@ -432,89 +510,64 @@ void AMain::BeginPlay()
 
 	if (FollowCamera)
 	{
-		CameraDefaultFOV = GetFollowCamera()->FieldOfView;
-		CameraCurrentFOV = CameraDefaultFOV;
+		CrosshairSpread->SetCamera(GetFollowCamera());
 	}
-	//spawn the default weapon and equip it
-	EquipWeapon(SpawnDefaultWeapon());
-	Inventory.Add(EquippedWeapon);
-	EquippedWeapon->SetSlotIndex(0);
+	InventoryComponent->OnSlotsChanged.AddDynamic(this, &AMain::OnInventorySlotsChanged);
 
-	InitializeAmmoMap();
-	
-}
-
-void AMain::AimingButtonPressed()
-{
-	bAiming = true;
-}
-
-void AMain::AimingButtonReleasesd()
-{
-	bAiming = false;
-}
-
-void AMain::CameraInterpZoom(float DeltaTime)
-{
-	//set current camera field of view
-	if (bAiming)
-	{
-		//interpolate to zoomed FOV
-		CameraCurrentFOV = FMath::FInterpTo(CameraCurrentFOV, CameraZoomedFOV, DeltaTime, ZoomInterpSpeed);
-	}
-	else
+	//spawn the default weapon, put it in the first slot and equip it
+	AWeapon* DefaultWeapon{ SpawnDefaultWeapon() };
+	if (DefaultWeapon)
 	{
-		//interpolate to default FOV
-		CameraCurrentFOV = FMath::FInterpTo(CameraCurrentFOV, CameraDefaultFOV, DeltaTime, ZoomInterpSpeed);
+		InventoryComponent->AddItem(DefaultWeapon);
+		EquipWeapon(DefaultWeapon);
 	}
-	GetFollowCamera()->SetFieldOfView(CameraCurrentFOV);
-}
-
-void AMain::CalculateCrossHairSpread(float DeltaTime)
-{
-	FVector2D WalkSpeedRange{0.f, 600.f};
-	FVector2D VelocityMultiplierRange{0.f, 1.f};
-	FVector Velocity{ GetVelocity() };
-	Velocity.Z = 0;
 
-	//calculate crosshair velocity factor
-	CrosshairVelocityFactor = FMath::GetMappedRangeValueClamped(WalkSpeedRange, VelocityMultiplierRange, Velocity.Size());
+	InitializeAmmoMap();
 
-	//claculate crosshair in air factor
-	if (GetCharacterMovement()->IsFalling()) //is in air?
+	//create the pooled particle components for the whip effects up front
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (FXPool)
 	{
-		//spread the crosshair slowly while in air
-		CrosshairInAirFactor = FMath::FInterpTo(CrosshairInAirFactor, 2.25f, DeltaTime, 2.25f);
-	}
-	else //character is on the ground
-	{
-		//shrink the crosshairs rapidly while on the gorund
-		CrosshairInAirFactor = FMath::FInterpTo(CrosshairInAirFactor, 0.f, DeltaTime, 30.f);
+		FXPool->PrewarmTemplate(MuzzleFlash);
+		FXPool->PrewarmTemplate(ImpactParticles);
+		FXPool->PrewarmTemplate(BeamParticles);
+		FXPool->PrewarmTemplate(BloodParticles);
+		FXPool->PrewarmTemplate(BulletProjectile.ImpactEffect);
 	}
 
-	if (bAiming) //are we aiming
-	{
-		//shrink crosshair a small amount very quickly
-		CrosshairAimFactor = FMath::FInterpTo(CrosshairInAirFactor, 0.6f, DeltaTime, 30.f);
-	}
-	else
+	//prime the combat cues and their voices so the first shot doesn't hitch
+	UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+	if (CombatAudio)
 	{
-		//spread crosshairs to normal very quickly
-		CrosshairAimFactor = FMath::FInterpTo(CrosshairInAirFactor, 0.f, DeltaTime, 30.f);
+		CombatAudio->PreloadSound(FireSound, ECombatSoundCategory::ECSC_WeaponFire);
+		CombatAudio->PreloadSound(MeleeImpactSound, ECombatSoundCategory::ECSC_Melee);
 	}
 
-	//true 0.05seconds after firing
-	if (bFiringWhip)
-	{
-		CrosshairShootingFactor = FMath::FInterpTo(CrosshairShootingFactor, 0.3f, DeltaTime, 60.f);
-	}
-	else
+	UProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<UProjectileSubsystem>();
+	if (Projectiles)
 	{
-		CrosshairShootingFactor = FMath::FInterpTo(CrosshairShootingFactor, 0.f, DeltaTime, 60.f);
+		BulletProjectileType = Projectiles->RegisterProjectileType(BulletProjectile);
 	}
+	
+}
+
+void AMain::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
+
+	CrosshairSpread->SetInAir(GetCharacterMovement()->IsFalling());
+}
+
+void AMain::AimingButtonPressed()
+{
+	bAiming = true;
+	CrosshairSpread->SetAiming(true);
+}
 
-	CrosshairSpreadMultiplier = 0.5f + CrosshairVelocityFactor + CrosshairInAirFactor - CrosshairAimFactor 
-		+ CrosshairShootingFactor;
+void AMain::AimingButtonReleasesd()
+{
+	bAiming = false;
+	CrosshairSpread->SetAiming(false);
 }
 
 void AMain::FireButtonPressed()
@@ -528,32 +581,33 @@ void AMain::FireButtonReleased()
 	bFireButtonPressed = false;
 }
 
-void AMain::StartFireTimer()
+void AMain::UpdateAutomaticFire(float DeltaTime)
 {
-	CombatState = ECombatState::ECS_FireTimerInProgress;
-	GetWorldTimerManager().SetTimer(AutoFireTimer, this, &AMain::AutoFireReset, AutomaticFireRate);
-}
+	if (CombatState != ECombatState::ECS_FireTimerInProgress) return;
 
-void AMain::AutoFireReset()
-{
-	CombatState = ECombatState::ECS_Unoccupied;
-	if (WeaponHasAmmo())
+	DueShotAges.Reset();
+	const int32 Ammo{ EquippedWeapon ? EquippedWeapon->GetAmmo() : 0 };
+	const int32 NumShots{ FireScheduler.Advance(DeltaTime, GFrameCounter, bFireButtonPressed, Ammo, DueShotAges) };
+	if (NumShots > 0)
 	{
-		if (bFireButtonPressed)
-		{
-			FireWeapon();
-		}
+		FireShots(DueShotAges);
 	}
-	else
+
+	if (!FireScheduler.IsActive())
 	{
-		//reload weapon
-		ReloadWeapon();
+		CombatState = ECombatState::ECS_Unoccupied;
+		if (!WeaponHasAmmo())
+		{
+			//reload weapon
+			ReloadWeapon();
+		}
 	}
 }
 
 void AMain::StartCrosshairWhipFire()
 {
 	bFiringWhip = true;
+	CrosshairSpread->SetFiring(true);
 
 	GetWorldTimerManager().SetTimer(CrosshairShootTimer, this, &AMain::FinishCrosshairWhipFire, ShootTimeDurartion);
 }
@@ -561,9 +615,31 @@ void AMain::StartCrosshairWhipFire()
 void AMain::FinishCrosshairWhipFire()
 {
 	bFiringWhip = false;
+	CrosshairSpread->SetFiring(false);
 }
 
 bool AMain::TraceUnderCrossHairs(FHitResult& OutHitResult, FVector& OuHitLocation)
+{
+	if (CrosshairTraceCache.FrameNumber == GFrameCounter)
+	{
+		//already traced this frame (item trace or an earlier shot)
+		++CrosshairTraceCacheHits;
+	}
+	else
+	{
+		++CrosshairTraceCacheMisses;
+		CrosshairTraceCache.HitResult = FHitResult();
+		CrosshairTraceCache.HitLocation = FVector::ZeroVector;
+		CrosshairTraceCache.bHit = TraceUnderCrossHairsUncached(CrosshairTraceCache.HitResult, CrosshairTraceCache.HitLocation);
+		CrosshairTraceCache.FrameNumber = GFrameCounter;
+	}
+
+	OutHitResult = CrosshairTraceCache.HitResult;
+	OuHitLocation = CrosshairTraceCache.HitLocation;
+	return CrosshairTraceCache.bHit;
+}
+
+bool AMain::GetCrosshairTraceSegment(FVector& OutStart, FVector& OutEnd)
 {
 	//get viewport size
 	FVector2D ViewportSize;
@@ -584,8 +660,19 @@ bool AMain::TraceUnderCrossHairs(FHitResult& OutHitResult, FVector& OuHitLocatio
 	if (bScreenToWorld)
 	{
 		//trace from crosshair world location outward
-		const FVector Start{ CrosshairWorldPosition };
-		const FVector End{ CrosshairWorldPosition + CrosshairWorldDirection * 50'000.f };
+		OutStart = CrosshairWorldPosition;
+		OutEnd = CrosshairWorldPosition + CrosshairWorldDirection * 50'000.f;
+	}
+
+	return bScreenToWorld;
+}
+
+bool AMain::TraceUnderCrossHairsUncached(FHitResult& OutHitResult, FVector& OuHitLocation)
+{
+	FVector Start;
+	FVector End;
+	if (GetCrosshairTraceSegment(Start, End))
+	{
 		OuHitLocation = End;
 		GetWorld()->LineTraceSingleByChannel(OutHitResult, Start, End, ECollisionChannel::ECC_Visibility);
 
@@ -603,73 +690,146 @@ void AMain::TraceForItems()
 {
 	if (bShouldTraceForItems)
 	{
-		FHitResult ItemTraceResult;
-		FVector HitLocation;
-		TraceUnderCrossHairs(ItemTraceResult, HitLocation);
-		if (ItemTraceResult.bBlockingHit)
+		if (CVarAsyncItemTrace.GetValueOnGameThread() != 0)
 		{
-			TraceHitItem = Cast<AItem>(ItemTraceResult.Actor);
-			const auto TraceHitWeapon = Cast<AWeapon>(TraceHitItem);
-			if (TraceHitWeapon)
-			{
-				if (HighlightedSlot == -1)
-				{
-					//not currently highlighting slot; highlight one
-					HighlightInventorySlot();
-				}
-			}
-			else
+			//consume the trace issued last frame, then issue the one for this frame
+			FHitResult ItemTraceResult;
+			if (ConsumeAsyncItemTrace(ItemTraceResult))
 			{
-				//is a slot being highlighted?
-				if (HighlightedSlot != -1)
-				{
-					//unhighlight the slot
-					UnHighlightInventorySlot();
-				}
+				ProcessItemTraceResult(ItemTraceResult);
 			}
+			RequestAsyncItemTrace();
+		}
+		else
+		{
+			ItemTraceHandle = FTraceHandle();
 
-			if (TraceHitItem && TraceHitItem->GetItemState() == EItemState::EIS_EquipInterping)
-			{
-				TraceHitItem = nullptr;
-			}
+			FHitResult ItemTraceResult;
+			FVector HitLocation;
+			TraceUnderCrossHairs(ItemTraceResult, HitLocation);
+			ProcessItemTraceResult(ItemTraceResult);
+		}
+	}
+	else
+	{
+		//drop any pending trace, its result would be stale by the time we trace again
+		ItemTraceHandle = FTraceHandle();
 
-			if (TraceHitItem && TraceHitItem->GetPickupWidget())
-			{
-				//show item pickup widget
-				TraceHitItem->GetPickupWidget()->SetVisibility(true);
+		if (TraceHitItemLastFrame)
+		{
+			// No longer overlapping any items,
+			// Item last frame should not show widget
+			HidePickupWidget();
+		}
 
-				if (Inventory.Num() >= INVENTORY_CAPACITY)
-				{
-					//inventory is full
-					TraceHitItem->SetCharacterInventoryFull(true);
-				}
-				else
-				{
-					//inventory is not full
-					TraceHitItem->SetCharacterInventoryFull(false);
-				}
-			}
+		//items that left the view cone can't be selected
+		TraceHitItem = nullptr;
+		TraceHitItemLastFrame = nullptr;
+	}
+}
+
+void AMain::RequestAsyncItemTrace()
+{
+	FVector Start;
+	FVector End;
+	if (GetCrosshairTraceSegment(Start, End))
+	{
+		ItemTraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, 
+			ECollisionChannel::ECC_Visibility);
+	}
+	else
+	{
+		ItemTraceHandle = FTraceHandle();
+	}
+}
+
+bool AMain::ConsumeAsyncItemTrace(FHitResult& OutHitResult)
+{
+	if (!ItemTraceHandle.IsValid()) return false;
 
-			// We hit an AItem last frame
-			if (TraceHitItemLastFrame)
+	FTraceDatum TraceDatum;
+	if (!GetWorld()->QueryTraceData(ItemTraceHandle, TraceDatum)) return false;
+
+	ItemTraceHandle = FTraceHandle();
+	if (TraceDatum.OutHits.Num() > 0)
+	{
+		OutHitResult = TraceDatum.OutHits[0];
+	}
+	return true;
+}
+
+void AMain::ProcessItemTraceResult(const FHitResult& ItemTraceResult)
+{
+	if (ItemTraceResult.bBlockingHit)
+	{
+		TraceHitItem = Cast<AItem>(ItemTraceResult.Actor);
+		const auto TraceHitWeapon = Cast<AWeapon>(TraceHitItem);
+		if (TraceHitWeapon)
+		{
+			if (HighlightedSlot == -1)
 			{
-				if (TraceHitItem != TraceHitItemLastFrame)
-				{
-					// We are hitting a different AItem this frame from last frame
-					// Or AItem is null.
-					TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
-				}
+				//not currently highlighting slot; highlight one
+				HighlightInventorySlot();
+			}
+		}
+		else
+		{
+			//is a slot being highlighted?
+			if (HighlightedSlot != -1)
+			{
+				//unhighlight the slot
+				UnHighlightInventorySlot();
 			}
+		}
+
+		if (TraceHitItem && TraceHitItem->GetItemState() == EItemState::EIS_EquipInterping)
+		{
+			TraceHitItem = nullptr;
+		}
 
-			//store a reference to hititem for next frame
-			TraceHitItemLastFrame = TraceHitItem;
+		if (TraceHitItem)
+		{
+			TraceHitItem->SetCharacterInventoryFull(InventoryComponent->IsFull());
+
+			//show item pickup widget, hides last frame's one
+			ShowPickupWidget(TraceHitItem);
+		}
+		else if (TraceHitItemLastFrame)
+		{
+			// We hit an AItem last frame but not this frame
+			HidePickupWidget();
 		}
+
+		//store a reference to hititem for next frame
+		TraceHitItemLastFrame = TraceHitItem;
+	}
+	else
+	{
+		//looking at nothing, e.g. the sky
+		TraceHitItem = nullptr;
+		TraceHitItemLastFrame = nullptr;
+		HidePickupWidget();
 	}
-	else if (TraceHitItemLastFrame)
+}
+
+void AMain::ShowPickupWidget(AItem* Item)
+{
+	if (Item == PickupWidgetItem) return;
+
+	HidePickupWidget();
+	if (Item)
 	{
-		// No longer overlapping any items,
-		// Item last frame should not show widget
-		TraceHitItemLastFrame->GetPickupWidget()->SetVisibility(false);
+		Item->SetPickupWidgetVisible(true);
+		PickupWidgetItem = Item;
+	}
+}
+
+void AMain::HidePickupWidget()
+{
+	if (PickupWidgetItem)
+	{
+		PickupWidgetItem->SetPickupWidgetVisible(false);
+		PickupWidgetItem = nullptr;
 	}
 }
 
@@ -698,15 +858,8 @@ void AMain::EquipWeapon(AWeapon* WeaponToEquip)
 			HandSocket->AttachActor(WeaponToEquip, GetMesh());
 		}
 
-		if (EquippedWeapon == nullptr)
-		{
-			//-1 no equipped weapon yet, hence no need to reverse the icon animation
-			EquipItemDelegate.Broadcast(-1, WeaponToEquip->GetSlotIndex());
-		}
-		else
-		{
-			EquipItemDelegate.Broadcast(EquippedWeapon->GetSlotIndex(), WeaponToEquip->GetSlotIndex());
-		}
+		//-1 no equipped weapon yet, hence no need to reverse the icon animation
+		InventoryComponent->NotifyEquipped(EquippedWeapon ? EquippedWeapon->GetSlotIndex() : -1, WeaponToEquip->GetSlotIndex());
 
 		// Set EquippedWeapon to the newly spawned Weapon
 		EquippedWeapon = WeaponToEquip;
@@ -719,13 +872,16 @@ void AMain::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	//handle interpolation for zoom when aiming
-	CameraInterpZoom(DeltaTime);
+	//wakes the zoom and crosshair spread interpolation only when our ground speed changed
+	FVector Velocity{ GetVelocity() };
+	Velocity.Z = 0;
+	CrosshairSpread->SetGroundSpeed(Velocity.Size());
 
-	//claculate crosshair spread multiplier
-	CalculateCrossHairSpread(DeltaTime);
+	//emit the automatic shots that fell due this frame
+	UpdateAutomaticFire(DeltaTime);
 
-	//check overlappeditemcount, then trace for items
+	//check nearby items, then trace for items
+	UpdateItemProximity();
 	TraceForItems();
 
 }
@@ -759,12 +915,14 @@ void AMain::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 
 	PlayerInputComponent->BindAction("ReloadButton", IE_Pressed, this, &AMain::ReloadButtonPressed);
 
-	PlayerInputComponent->BindAction("FKey", IE_Pressed, this, &AMain::FKeyPressed);
-	PlayerInputComponent->BindAction("1Key", IE_Pressed, this, &AMain::OneKeyPressed);
-	PlayerInputComponent->BindAction("2Key", IE_Pressed, this, &AMain::TwoKeyPressed);
-	PlayerInputComponent->BindAction("3Key", IE_Pressed, this, &AMain::ThreeKeyPressed);
-	PlayerInputComponent->BindAction("4Key", IE_Pressed, this, &AMain::FourKeyPressed);
-	PlayerInputComponent->BindAction("5Key", IE_Pressed, this, &AMain::FiveKeyPressed);
+	//inventory slot keys, the index in this list is the slot they select
+	static const FName SlotKeyActions[]{ FName("FKey"), FName("1Key"), FName("2Key"), FName("3Key"), FName("4Key"), 
+		FName("5Key") };
+	for (int32 SlotIndex = 0; SlotIndex < UE_ARRAY_COUNT(SlotKeyActions); SlotIndex++)
+	{
+		PlayerInputComponent->BindAction<FSelectSlotDelegate>(SlotKeyActions[SlotIndex], IE_Pressed, this, 
+			&AMain::SlotKeyPressed, SlotIndex);
+	}
 
 }
 
@@ -811,14 +969,28 @@ void AMain::FireWeapon()
 
 	if (WeaponHasAmmo())
 	{
-		PlayFireSound();
-		SendBullet();
-		PlayGunFireMontage();
+		//the first round is due right now
+		DueShotAges.Reset();
+		DueShotAges.Add(0.f);
+		FireShots(DueShotAges);
+
+		//following shots come from the scheduler while the button is held
+		FireScheduler.Start(AutomaticFireRate, GFrameCounter);
+		CombatState = ECombatState::ECS_FireTimerInProgress;
+	}
+}
 
-		//subtract one from the weapon's ammo
-		EquippedWeapon->DecrementAmmo();
+void AMain::FireShots(const TArray<float>& ShotAges)
+{
+	//rounds that fall due in the same frame share the sound, montage and muzzle flash but each gets its own trace
+	PlayFireSound();
+	SendBullet(ShotAges);
+	PlayGunFireMontage();
 
-		StartFireTimer();
+	//subtract the rounds from the weapon's ammo
+	for (int32 Shot = 0; Shot < ShotAges.Num(); Shot++)
+	{
+		EquippedWeapon->DecrementAmmo();
 	}
 }
 
@@ -900,20 +1072,47 @@ void AMain::FinishEquipping()
 
 float AMain::GetCrossHairSpreadMultiplier() const
 {
-	return CrosshairSpreadMultiplier;
+	return CrosshairSpread->GetSpreadMultiplier();
 }
 
-void AMain::IncrementOverlappedItemCount(int8 Amount)
+void AMain::UpdateItemProximity()
 {
-	if (OverlappedItemCount + Amount <= 0)
+	UItemProximitySubsystem* Proximity = GetWorld()->GetSubsystem<UItemProximitySubsystem>();
+	if (Proximity == nullptr) return;
+
+	const bool bHadNearbyItems{ NearbyItems.Num() > 0 };
+
+	//query again only after moving far enough or when items were added/removed
+	const FVector Location{ GetActorLocation() };
+	if (Proximity->GetRevision() != LastProximityRevision ||
+		FVector::DistSquared(Location, LastProximityLocation) > ProximityRequeryDistance * ProximityRequeryDistance)
 	{
-		OverlappedItemCount = 0;
-		bShouldTraceForItems = false;
+		Proximity->QueryItems(Location, NearbyItems);
+		LastProximityLocation = Location;
+		LastProximityRevision = Proximity->GetRevision();
 	}
-	else
+
+	if (bHadNearbyItems && NearbyItems.Num() == 0)
 	{
-		OverlappedItemCount += Amount;
-		bShouldTraceForItems = true;
+		//walked away from the last item
+		UnHighlightInventorySlot();
+	}
+
+	//skip the trace when none of the nearby items can be under the crosshair
+	bShouldTraceForItems = false;
+	const FVector CameraLocation{ FollowCamera->GetComponentLocation() };
+	const FVector CameraForward{ FollowCamera->GetForwardVector() };
+	const float CosHalfAngle{ FMath::Cos(FMath::DegreesToRadians(ItemViewConeAngle * 0.5f)) };
+	for (const AItem* Item : NearbyItems)
+	{
+		if (Item == nullptr) continue;
+
+		const FVector ToItem{ (Item->GetActorLocation() - CameraLocation).GetSafeNormal() };
+		if (FVector::DotProduct(ToItem, CameraForward) >= CosHalfAngle)
+		{
+			bShouldTraceForItems = true;
+			break;
+		}
 	}
 }
 
@@ -926,19 +1125,26 @@ FVector AMain::GetCameraInterpLocation()
 
 void AMain::GetPickupItem(AItem* Item)
 {
-	if (Item->GetEquipSound())
+	UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+	if (Item->GetEquipSound() && CombatAudio)
+	{
+		CombatAudio->PlaySound2D(Item->GetEquipSound(), ECombatSoundCategory::ECSC_Interface);
+	}
+
+	if (PickupWidgetItem == Item)
 	{
-		UGameplayStatics::PlaySound2D(this, Item->GetEquipSound());
+		HidePickupWidget();
 	}
 
 	auto Weapon = Cast<AWeapon>(Item);
 	if (Weapon)
 	{
-		if (Inventory.Num() < INVENTORY_CAPACITY)
+		const int32 SlotIndex{ InventoryComponent->AddItem(Weapon) };
+		if (SlotIndex != INDEX_NONE)
 		{
-			Weapon->SetSlotIndex(Inventory.Num());
-			Inventory.Add(Weapon);
 			Weapon->SetItemState(EItemState::EIS_PickedUp);
+			//unequipped weapons don't need an actor until they are selected
+			InventoryComponent->DehydrateSlot(SlotIndex);
 		}
 		else //inventory is full, hece swapped wit equipped weapon
 		{
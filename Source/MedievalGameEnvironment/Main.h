@@ -4,7 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "WorldCollision.h"
 #include "AmmoType.h"
+#include "InventoryComponent.h"
+#include "FireScheduler.h"
+#include "ProjectileSubsystem.h"
 #include "Main.generated.h"
 
 UENUM(BlueprintType)
@@ -17,8 +21,30 @@ enum class ECombatState : uint8
 	ECS_MAX UMETA(DisplayName = "DefaultMax")
 };
 
+//result of the crosshair trace, reused by every query made in the same frame
+USTRUCT(BlueprintType)
+struct FCrosshairTraceCache
+{
+	GENERATED_BODY()
+
+	//GFrameCounter value of the frame the trace was made in
+	uint64 FrameNumber = MAX_uint64;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FHitResult HitResult;
+
+	//hit location, or the trace end when nothing was hit
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FVector HitLocation = FVector::ZeroVector;
+
+	//true when the trace hit something
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bHit = false;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FEquipItemDelegate, int32, CurrentSlotIndex, int32, NewSlotIndex);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FHighlightIconDelegate, int32, SlotIndex, bool, bStartAnimation);
+DECLARE_DELEGATE_OneParam(FSelectSlotDelegate, int32);
 
 UCLASS()
 class MEDIEVALGAMEENVIRONMENT_API AMain : public ACharacter
@@ -66,42 +92,25 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	UParticleSystem* BeamParticles;
 
-	//true when aiming
-	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	bool bAiming;
-
-	//default camera field of view value
-	float CameraDefaultFOV;
-
-	//field of view value when zoomed in
-	float CameraZoomedFOV;
-
-	//current field of view this frame
-	float CameraCurrentFOV;
-
-	//interp speed for zooming when aiming
+	//shots travel as simulated projectiles instead of instant traces
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	float ZoomInterpSpeed;
+	bool bFireProjectiles;
 
-	//determines the spread of the crosshair
-	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	float CrosshairSpreadMultiplier;
-
-	//velocity component of crosshair spread
-	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	float CrosshairVelocityFactor;
+	//projectile fired when bFireProjectiles is set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FProjectileParams BulletProjectile;
 
-	//in air component of the crosshair spread
-	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	float CrosshairInAirFactor;
+	//type registered with the projectile subsystem for BulletProjectile, registered even while bFireProjectiles is off
+	//so it can be switched on at runtime
+	int32 BulletProjectileType;
 
-	//aim component of the crosshair spread
+	//true when aiming
 	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	float CrosshairAimFactor;
+	bool bAiming;
 
-	//shooting component of the crosshair spread
-	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	float CrosshairShootingFactor;
+	//camera zoom and crosshair spread, only ticks while something is changing
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	class UCrosshairSpreadComponent* CrosshairSpread;
 
 	//left mouse button pressed or right console trigger pressed
 	bool bFireButtonPressed;
@@ -112,13 +121,28 @@ public:
 	//rate of automatic gun fire
 	float AutomaticFireRate;
 
-	//sets a timer between gunshots
-	FTimerHandle AutoFireTimer;
+	//shot clock between gunshots, advanced in Tick
+	FFireScheduler FireScheduler;
+
+	//ages of the shots that fell due this frame, kept to reuse the allocation
+	TArray<float> DueShotAges;
 
 	float ShootTimeDurartion;
 	bool bFiringWhip;
 	FTimerHandle CrosshairShootTimer;
 
+	//crosshair trace shared by item tracing and firing within a frame
+	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	FCrosshairTraceCache CrosshairTraceCache;
+
+	//crosshair queries served from the cache
+	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	int32 CrosshairTraceCacheHits;
+
+	//crosshair queries that had to run the trace
+	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	int32 CrosshairTraceCacheMisses;
+
 	//character health
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
 		float Health;
@@ -151,32 +175,51 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	//wakes the crosshair spread when we start or stop falling
+	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
+
 	//set bAiming to true or false with button press
 	void AimingButtonPressed();
 	void AimingButtonReleasesd();
 
-	void CameraInterpZoom(float DeltaTime);
-
-	void CalculateCrossHairSpread(float DeltaTime);
-
 	void FireButtonPressed();
 	void FireButtonReleased();
 
-	void StartFireTimer();
+	//fires every automatic shot that fell due this frame, then reloads or frees the combat state once the clock stops
+	void UpdateAutomaticFire(float DeltaTime);
 
-	UFUNCTION()
-	void AutoFireReset();
+	//fires the rounds that fell due this frame, ShotAges holds how long before the end of the frame each was due
+	void FireShots(const TArray<float>& ShotAges);
 
 	void StartCrosshairWhipFire();
 
 	UFUNCTION()
 	void FinishCrosshairWhipFire();
 
+	//returns the crosshair trace for this frame, tracing only on the first call of the frame
 	bool TraceUnderCrossHairs(FHitResult& OutHitResult, FVector& OuHitLocation);
 
-	//trace for items if overlappeditemcount > 0
+	//deprojects the viewport centre and runs the visibility trace
+	bool TraceUnderCrossHairsUncached(FHitResult& OutHitResult, FVector& OuHitLocation);
+
+	//crosshair trace start and end in world space, false if the viewport centre can't be deprojected
+	bool GetCrosshairTraceSegment(FVector& OutStart, FVector& OutEnd);
+
+	//queries nearby items and decides if tracing for items is needed this frame
+	void UpdateItemProximity();
+
+	//trace for items if a nearby item is in view
 	void TraceForItems();
 
+	//issues the item trace for this frame (Main.AsyncItemTrace 1)
+	void RequestAsyncItemTrace();
+
+	//fetches the result of the item trace issued last frame, false if there is none yet
+	bool ConsumeAsyncItemTrace(FHitResult& OutHitResult);
+
+	//updates TraceHitItem, the pickup widget and the highlighted slot from an item trace
+	void ProcessItemTraceResult(const FHitResult& ItemTraceResult);
+
 	//spawns a default weapon and equips it
 	class AWeapon* SpawnDefaultWeapon();
 
@@ -200,7 +243,9 @@ protected:
 
 	//fire weapon functions
 	void PlayFireSound();
-	void SendBullet();
+	//one trace or projectile per round, each from where the muzzle was when the round fell due
+	void SendBullet(const TArray<float>& ShotAges);
+
 	void PlayGunFireMontage();
 
 	void ReloadButtonPressed();
@@ -215,19 +260,29 @@ protected:
 	UFUNCTION(BlueprintCallable)
 	void GrabClip();
 
-	void FKeyPressed();
-	void OneKeyPressed();
-	void TwoKeyPressed();
-	void ThreeKeyPressed();
-	void FourKeyPressed();
-	void FiveKeyPressed();
+	//equips the item in the given inventory slot (FKey is slot 0, 1Key-5Key are slots 1-5)
+	void SlotKeyPressed(int32 SlotIndex);
 
 	void ExchangeInventoryItems(int32 CurrentItemIndex, int32 NewItemIndex);
 
+	//retries the slot selection that was waiting for its weapon assets
+	void OnPendingEquipAssetsLoaded();
+
 	int32 GetEmptyInventorySlot();
 
 	void HighlightInventorySlot();
 
+	//shows the item's pickup widget and hides the one shown before
+	void ShowPickupWidget(AItem* Item);
+	void HidePickupWidget();
+
+	//copies the live slot items into Inventory
+	void RefreshInventoryItems();
+
+	//forwards the batched inventory slot events to the inventory bar delegates
+	UFUNCTION()
+	void OnInventorySlotsChanged(const TArray<FInventorySlotEvent>& SlotEvents);
+
 	void Die();
 
 	UFUNCTION(BlueprintCallable)
@@ -237,6 +292,9 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	//whip and bullet damage for a hit on an enemy, also used by UProjectileSubsystem
+	float GetHitDamage(const class AEnemy* HitEnemy, const FHitResult& HitResult) const;
+
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -264,8 +322,24 @@ public:
 	//true if we should trace for every items 
 	bool bShouldTraceForItems;
 
-	//number of overlapped aitems
-	int8 OverlappedItemCount;
+	//pending async item trace
+	FTraceHandle ItemTraceHandle;
+
+	//items whose pickup radius contains the character, from UItemProximitySubsystem
+	UPROPERTY(Transient)
+	TArray<AItem*> NearbyItems;
+
+	//location and registry revision of the last proximity query
+	FVector LastProximityLocation;
+	uint32 LastProximityRevision;
+
+	//distance the character has to move before the proximity registry is queried again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
+	float ProximityRequeryDistance;
+
+	//only nearby items inside this cone around the camera forward (degrees, full angle) are worth tracing for
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
+	float ItemViewConeAngle;
 
 	//the aitem we hit last frame
 	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Items, meta = (AllowPrivateAccess = "true"))
@@ -303,11 +377,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Items, meta = (AllowPrivateAccess = "true"))
 	int32 StartingARAmmo;
 
-	//an array of AItems for inventory
+	//inventory slots, capacity is set on the component
+	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
+	class UInventoryComponent* InventoryComponent;
+
+	//live item per inventory slot, mirrored from InventoryComponent for the WeaponSlot and InventoryBar widgets.
+	//trailing empty slots are left out, dehydrated slots are nullptr
 	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
 	TArray<AItem*> Inventory;
 
-	const int32 INVENTORY_CAPACITY{ 2 };
+	//item whose pickup widget is shown, at most one at a time
+	UPROPERTY()
+	AItem* PickupWidgetItem;
 
 	//delegates for sending slot information to inventoryBar while equipping
 	UPROPERTY(BlueprintAssignable, Category = Delegates, meta = (AllowPrivateAccess = "true"))
@@ -321,6 +402,9 @@ public:
 	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
 	int32 HighlightedSlot;
 
+	//slot selected while its weapon assets were still streaming in, -1 if none
+	int32 PendingEquipSlot;
+
 	//combat state can only fire or reload if unoccupied
 	UPROPERTY(Visibleanywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
 	ECombatState CombatState;
@@ -368,10 +452,9 @@ public:
 	UFUNCTION(BlueprintCallable)
 	float GetCrossHairSpreadMultiplier() const;
 
-	FORCEINLINE int8 GetOverlappedItemCount() const 
-	{
-		return OverlappedItemCount;
-	}
+	FORCEINLINE UCrosshairSpreadComponent* GetCrosshairSpread() const { return CrosshairSpread; }
+
+	FORCEINLINE int32 GetNumNearbyItems() const { return NearbyItems.Num(); }
 
 	void UnHighlightInventorySlot();
 
@@ -381,9 +464,6 @@ public:
 	FORCEINLINE USoundCue* GetMeleeImpactSound() const { return MeleeImpactSound; }
 	FORCEINLINE UParticleSystem* GetBloodParticles() const { return BloodParticles; }
 
-	//adds/sunstarcts to/from overlappedItemcount and update bshouldtraceforitems
-	void IncrementOverlappedItemCount(int8 Amount);
-
 	FVector GetCameraInterpLocation();
 
 	void GetPickupItem(AItem* Item);
@@ -391,6 +471,10 @@ public:
 	void Stun();
 	FORCEINLINE float GetStunChance() const { return StunChance; }
 	FORCEINLINE AWeapon* GetEquippedWeapon() const { return EquippedWeapon; }
+	FORCEINLINE UInventoryComponent* GetInventory() const { return InventoryComponent; }
+	FORCEINLINE const TArray<AItem*>& GetInventoryItems() const { return Inventory; }
 	FORCEINLINE ECombatState GetCombatState() const { return CombatState; }
+	FORCEINLINE int32 GetCrosshairTraceCacheHits() const { return CrosshairTraceCacheHits; }
+	FORCEINLINE int32 GetCrosshairTraceCacheMisses() const { return CrosshairTraceCacheMisses; }
 
 };
@@ -0,0 +1,317 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "MeleeBenchmark.h"
+#include "MeleeTraceComponent.h"
+#include "Enemy.h"
+#include "Main.h"
+#include "Components/BoxComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "EngineUtils.h"
+#include "Tickable.h"
+#include "HAL/IConsoleManager.h"
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Surrounds the player with attacking wraiths and runs the same number of frames with the swept trace shapes
+ * and with the overlap boxes, then logs the frame time and hits of both.
+ */
+class FMeleeBenchmark : public FTickableGameObject
+{
+public:
+	FMeleeBenchmark(UWorld* InWorld, int32 InFramesPerPhase) : World(InWorld), FramesPerPhase(InFramesPerPhase), Phase(0),
+		Frame(0), PhaseStartTime(0.0), PhaseStartHits(0), PhaseAttacks(0), bCharacterCouldBeDamaged(true), bFinished(false)
+	{
+		Character = Cast<AMain>(UGameplayStatics::GetPlayerPawn(InWorld, 0));
+
+		//any enemy in the level (pooled ones included) provides the wraith class
+		TActorIterator<AEnemy> It(InWorld);
+		if (!Character.IsValid() || !It)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Melee benchmark needs a player character and an enemy in the level"));
+			bFinished = true;
+			return;
+		}
+
+		//the character is counted as hit but takes no damage, so it survives both phases
+		bCharacterCouldBeDamaged = Character->CanBeDamaged();
+		Character->SetCanBeDamaged(false);
+
+		UClass* EnemyClass{ It->GetClass() };
+		const FVector Center{ Character->GetActorLocation() };
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+		for (int32 i = 0; i < NumEnemies; i++)
+		{
+			const FRotator Around{ 0.f, 360.f * i / NumEnemies, 0.f };
+			const FVector Location{ Center + Around.Vector() * 120.f };
+			const FRotator Facing{ (Center - Location).Rotation() };
+			AEnemy* Enemy = InWorld->SpawnActor<AEnemy>(EnemyClass, Location, Facing, SpawnParams);
+			if (Enemy == nullptr) continue;
+
+			if (Enemy->GetController() == nullptr)
+			{
+				Enemy->SpawnDefaultController();
+			}
+
+			UMeleeBenchmarkComponent* Probe = NewObject<UMeleeBenchmarkComponent>(Enemy);
+			Probe->RegisterComponent();
+			Probe->SetMeleeTrace(Enemy->GetMeleeTrace());
+			Enemies.Add(Enemy);
+			Probes.Add(Probe);
+		}
+
+		StartPhase();
+	}
+
+	virtual void Tick(float DeltaTime) override
+	{
+		for (const TWeakObjectPtr<AEnemy>& Enemy : Enemies)
+		{
+			if (Enemy.IsValid() && StartAttack(Enemy.Get()))
+			{
+				PhaseAttacks++;
+			}
+		}
+
+		if (++Frame < FramesPerPhase) return;
+
+		const double ElapsedMs{ (FPlatformTime::Seconds() - PhaseStartTime) * 1000.0 };
+		const int32 Hits{ CountHits() - PhaseStartHits };
+		UE_LOG(LogTemp, Log, TEXT("Melee benchmark (%s): %d wraiths, %.3f ms per frame, %d attacks, %d hits, %.2f hits per attack"),
+			Phase == 0 ? TEXT("swept shapes") : TEXT("overlap boxes"), Enemies.Num(), ElapsedMs / FramesPerPhase,
+			PhaseAttacks, Hits, PhaseAttacks > 0 ? static_cast<float>(Hits) / PhaseAttacks : 0.f);
+
+		if (++Phase < 2)
+		{
+			StartPhase();
+			return;
+		}
+		Finish();
+	}
+
+	virtual bool IsTickable() const override { return !bFinished && World.IsValid(); }
+	virtual UWorld* GetTickableGameObjectWorld() const override { return World.Get(); }
+	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(FMeleeBenchmark, STATGROUP_Tickables); }
+
+	FORCEINLINE bool IsFinished() const { return bFinished; }
+
+private:
+	//starts a random attack with every weapon and foot active unless one is still playing
+	static bool StartAttack(AEnemy* Enemy)
+	{
+		UAnimInstance* AnimInstance = Enemy->GetMesh()->GetAnimInstance();
+		if (Enemy->IsDying() || AnimInstance == nullptr || Enemy->GetAttackMontage() == nullptr) return false;
+		if (AnimInstance->Montage_IsPlaying(Enemy->GetAttackMontage())) return false;
+
+		Enemy->StopMeleeAttack();
+		Enemy->PlayAttackMontage(Enemy->GetAttackSectionName(), 1.f);
+
+		UMeleeTraceComponent* MeleeTrace{ Enemy->GetMeleeTrace() };
+		const TArray<FMeleeTraceShape>& Shapes = MeleeTrace->GetShapes();
+		for (int32 i = 0; i < Shapes.Num(); i++)
+		{
+			MeleeTrace->SetShapeActive(Shapes[i].Name, true);
+		}
+		return true;
+	}
+
+	int32 CountHits() const
+	{
+		int32 Hits{ 0 };
+		for (const TWeakObjectPtr<UMeleeBenchmarkComponent>& Probe : Probes)
+		{
+			if (Probe.IsValid())
+			{
+				Hits += Probe->GetNumCharacterHits();
+			}
+		}
+		return Hits;
+	}
+
+	void StartPhase()
+	{
+		for (int32 i = 0; i < Enemies.Num(); i++)
+		{
+			if (Enemies[i].IsValid() && Probes[i].IsValid())
+			{
+				Enemies[i]->StopMeleeAttack();
+				Probes[i]->SetUseOverlapBoxes(Phase == 1);
+			}
+		}
+
+		Frame = 0;
+		PhaseAttacks = 0;
+		PhaseStartHits = CountHits();
+		PhaseStartTime = FPlatformTime::Seconds();
+	}
+
+	void Finish()
+	{
+		bFinished = true;
+		for (const TWeakObjectPtr<AEnemy>& Enemy : Enemies)
+		{
+			if (Enemy.IsValid())
+			{
+				if (AController* Controller = Enemy->GetController())
+				{
+					Controller->Destroy();
+				}
+				Enemy->Destroy();
+			}
+		}
+		Enemies.Reset();
+		Probes.Reset();
+
+		if (Character.IsValid())
+		{
+			Character->SetCanBeDamaged(bCharacterCouldBeDamaged);
+		}
+	}
+
+	static const int32 NumEnemies{ 50 };
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<AMain> Character;
+	TArray<TWeakObjectPtr<AEnemy>> Enemies;
+	//same order as Enemies
+	TArray<TWeakObjectPtr<UMeleeBenchmarkComponent>> Probes;
+	int32 FramesPerPhase;
+	int32 Phase;
+	int32 Frame;
+	double PhaseStartTime;
+	int32 PhaseStartHits;
+	int32 PhaseAttacks;
+	bool bCharacterCouldBeDamaged;
+	bool bFinished;
+};
+
+static TUniquePtr<FMeleeBenchmark> GMeleeBenchmark;
+
+static FAutoConsoleCommandWithWorldAndArgs GMeleeBenchmarkCommand(
+	TEXT("Melee.Benchmark"),
+	TEXT("Surrounds the player with 50 attacking wraiths and compares the swept trace shapes with overlap boxes. ")
+	TEXT("Usage: Melee.Benchmark [FramesPerPath=300]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr) return;
+		if (GMeleeBenchmark.IsValid() && !GMeleeBenchmark->IsFinished())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Melee benchmark is already running"));
+			return;
+		}
+
+		const int32 Frames{ Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 300 };
+		GMeleeBenchmark = MakeUnique<FMeleeBenchmark>(World, Frames);
+	}));
+
+#endif
+
+UMeleeBenchmarkComponent::UMeleeBenchmarkComponent() : MeleeTrace(nullptr), NumCharacterHits(0)
+{
+	//follows the trace shapes after the animation has switched them
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UMeleeBenchmarkComponent::SetMeleeTrace(UMeleeTraceComponent* InMeleeTrace)
+{
+	MeleeTrace = InMeleeTrace;
+	if (MeleeTrace)
+	{
+		MeleeTrace->OnMeleeHit.AddDynamic(this, &UMeleeBenchmarkComponent::OnMeleeHit);
+	}
+}
+
+void UMeleeBenchmarkComponent::SetUseOverlapBoxes(bool bUse)
+{
+	if (MeleeTrace == nullptr) return;
+
+	if (bUse && OverlapBoxes.Num() == 0)
+	{
+		CreateOverlapBoxes();
+	}
+	if (!bUse)
+	{
+		for (UBoxComponent* Box : OverlapBoxes)
+		{
+			Box->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		}
+	}
+
+	MeleeTrace->SetSweepsEnabled(!bUse);
+	SetComponentTickEnabled(bUse);
+}
+
+void UMeleeBenchmarkComponent::CreateOverlapBoxes()
+{
+	ACharacter* Character = Cast<ACharacter>(GetOwner());
+	USkeletalMeshComponent* Mesh{ Character ? Character->GetMesh() : nullptr };
+	if (Mesh == nullptr) return;
+
+	for (const FMeleeTraceShape& Shape : MeleeTrace->GetShapes())
+	{
+		UBoxComponent* Box = NewObject<UBoxComponent>(GetOwner());
+		Box->SetupAttachment(Mesh, Shape.StartSocket);
+
+		//a weapon box spans the swept segment, a foot box surrounds the swept sphere
+		FVector Extent{ Shape.Radius };
+		if (!Shape.EndSocket.IsNone())
+		{
+			const FVector End{ Mesh->GetSocketTransform(Shape.StartSocket).InverseTransformPosition(Mesh->GetSocketLocation(Shape.EndSocket)) };
+			Box->SetRelativeLocationAndRotation(End * 0.5f, End.Rotation());
+			Extent.X += End.Size() * 0.5f;
+		}
+		Box->SetBoxExtent(Extent, false);
+
+		Box->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Box->SetCollisionObjectType(ECollisionChannel::ECC_WorldDynamic);
+		Box->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+		Box->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
+		Box->OnComponentBeginOverlap.AddDynamic(this, &UMeleeBenchmarkComponent::OnBoxOverlap);
+		Box->RegisterComponent();
+		OverlapBoxes.Add(Box);
+	}
+}
+
+void UMeleeBenchmarkComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (MeleeTrace == nullptr) return;
+
+	//a box only has collision while its shape is switched on, like the old anim notify path
+	const TArray<FMeleeTraceShape>& Shapes = MeleeTrace->GetShapes();
+	for (int32 i = 0; i < OverlapBoxes.Num() && i < Shapes.Num(); i++)
+	{
+		const ECollisionEnabled::Type Collision{ Shapes[i].bActive ? ECollisionEnabled::QueryOnly : ECollisionEnabled::NoCollision };
+		if (OverlapBoxes[i]->GetCollisionEnabled() != Collision)
+		{
+			OverlapBoxes[i]->SetCollisionEnabled(Collision);
+		}
+	}
+}
+
+void UMeleeBenchmarkComponent::OnMeleeHit(const FHitResult& HitResult, FName ShapeName)
+{
+	if (Cast<AMain>(HitResult.GetActor()))
+	{
+		NumCharacterHits++;
+	}
+}
+
+void UMeleeBenchmarkComponent::OnBoxOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
+	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	if (OtherActor == nullptr || OtherActor == GetOwner() || MeleeTrace == nullptr) return;
+
+	const int32 ShapeIndex{ OverlapBoxes.IndexOfByKey(OverlappedComponent) };
+	if (!MeleeTrace->GetShapes().IsValidIndex(ShapeIndex)) return;
+
+	const FHitResult Hit(OtherActor, OtherComp, OtherComp ? OtherComp->GetComponentLocation() : OtherActor->GetActorLocation(),
+		FVector::ZeroVector);
+	MeleeTrace->OnMeleeHit.Broadcast(Hit, MeleeTrace->GetShapes()[ShapeIndex].Name);
+}
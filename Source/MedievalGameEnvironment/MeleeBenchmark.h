@@ -0,0 +1,55 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "MeleeBenchmark.generated.h"
+
+class UBoxComponent;
+class UMeleeTraceComponent;
+
+/**
+ * Added by Melee.Benchmark to the wraiths it spawns, enemies never create it themselves. Counts the enemy's hits on
+ * the character and, for the comparison run, detects them with overlap boxes on the striking parts (the old path)
+ * instead of the melee trace sweeps.
+ */
+UCLASS(ClassGroup = (Custom))
+class MEDIEVALGAMEENVIRONMENT_API UMeleeBenchmarkComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UMeleeBenchmarkComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	//melee trace of the owning enemy, its hits are counted
+	void SetMeleeTrace(UMeleeTraceComponent* InMeleeTrace);
+
+	//true: one overlap box follows each trace shape and the sweeps are off, false: the sweeps detect the hits
+	void SetUseOverlapBoxes(bool bUse);
+
+	FORCEINLINE int32 GetNumCharacterHits() const { return NumCharacterHits; }
+
+private:
+	//boxes are made on first use, sized from the trace shapes
+	void CreateOverlapBoxes();
+
+	UFUNCTION()
+	void OnMeleeHit(const FHitResult& HitResult, FName ShapeName);
+
+	//reports a box overlap through the melee trace, so the enemy applies it like a sweep hit
+	UFUNCTION()
+	void OnBoxOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
+		int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	UPROPERTY()
+	UMeleeTraceComponent* MeleeTrace;
+
+	//one box per trace shape, in the order of UMeleeTraceComponent::GetShapes
+	UPROPERTY()
+	TArray<UBoxComponent*> OverlapBoxes;
+
+	int32 NumCharacterHits;
+};
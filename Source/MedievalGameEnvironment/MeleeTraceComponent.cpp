@@ -0,0 +1,160 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "MeleeTraceComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Melee Sweeps"), STAT_MeleeSweeps, STATGROUP_Melee);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sweeps"), STAT_MeleeNumSweeps, STATGROUP_Melee);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Shapes"), STAT_MeleeActiveShapes, STATGROUP_Melee);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hits"), STAT_MeleeHits, STATGROUP_Melee);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Repeat Hits Ignored"), STAT_MeleeRepeatHits, STATGROUP_Melee);
+
+UMeleeTraceComponent::UMeleeTraceComponent() : TraceMesh(nullptr), bSweepsEnabled(true)
+{
+	//runs after the animation has moved the sockets
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	TargetObjectTypes.Add(UEngineTypes::ConvertToObjectType(ECC_Pawn));
+}
+
+void UMeleeTraceComponent::SetMesh(USkeletalMeshComponent* Mesh)
+{
+	TraceMesh = Mesh;
+}
+
+void UMeleeTraceComponent::AddShape(const FMeleeTraceShape& Shape)
+{
+	Shapes.Add(Shape);
+}
+
+void UMeleeTraceComponent::BeginSwing()
+{
+	SwingHitActors.Reset();
+}
+
+void UMeleeTraceComponent::SetShapeActive(FName ShapeName, bool bActive)
+{
+	FMeleeTraceShape* Shape = Shapes.FindByPredicate([ShapeName](const FMeleeTraceShape& Candidate) { return Candidate.Name == ShapeName; });
+	if (Shape == nullptr || Shape->bActive == bActive) return;
+
+	Shape->bActive = bActive;
+	if (bActive && bSweepsEnabled)
+	{
+		//the first sweep goes from where the shape is right now
+		SampleShape(*Shape, Shape->PreviousSamples);
+		SweepShape(*Shape);
+	}
+	UpdateTickEnabled();
+}
+
+void UMeleeTraceComponent::StopTracing()
+{
+	for (FMeleeTraceShape& Shape : Shapes)
+	{
+		Shape.bActive = false;
+	}
+	UpdateTickEnabled();
+}
+
+void UMeleeTraceComponent::SetSweepsEnabled(bool bEnabled)
+{
+	if (bSweepsEnabled == bEnabled) return;
+
+	bSweepsEnabled = bEnabled;
+	if (bSweepsEnabled)
+	{
+		//shapes switched on in the meantime sweep from where they are now
+		for (FMeleeTraceShape& Shape : Shapes)
+		{
+			if (Shape.bActive)
+			{
+				SampleShape(Shape, Shape.PreviousSamples);
+			}
+		}
+	}
+	UpdateTickEnabled();
+}
+
+void UMeleeTraceComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_MeleeSweeps);
+	for (FMeleeTraceShape& Shape : Shapes)
+	{
+		if (Shape.bActive)
+		{
+			SweepShape(Shape);
+			INC_DWORD_STAT(STAT_MeleeActiveShapes);
+		}
+	}
+}
+
+void UMeleeTraceComponent::SampleShape(const FMeleeTraceShape& Shape, TArray<FVector>& OutSamples) const
+{
+	OutSamples.Reset();
+	if (TraceMesh == nullptr) return;
+
+	const FVector Start{ TraceMesh->GetSocketLocation(Shape.StartSocket) };
+	if (Shape.EndSocket.IsNone() || Shape.NumSamples <= 1)
+	{
+		OutSamples.Add(Start);
+		return;
+	}
+
+	const FVector End{ TraceMesh->GetSocketLocation(Shape.EndSocket) };
+	for (int32 i = 0; i < Shape.NumSamples; i++)
+	{
+		OutSamples.Add(FMath::Lerp(Start, End, static_cast<float>(i) / (Shape.NumSamples - 1)));
+	}
+}
+
+void UMeleeTraceComponent::SweepShape(FMeleeTraceShape& Shape)
+{
+	SampleShape(Shape, CurrentSamples);
+	if (CurrentSamples.Num() != Shape.PreviousSamples.Num())
+	{
+		Shape.PreviousSamples = CurrentSamples;
+	}
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(MeleeTrace), false, GetOwner());
+	const FCollisionObjectQueryParams ObjectParams(TargetObjectTypes);
+	const FCollisionShape Sphere{ FCollisionShape::MakeSphere(Shape.Radius) };
+
+	for (int32 i = 0; i < CurrentSamples.Num(); i++)
+	{
+		SweepHits.Reset();
+		GetWorld()->SweepMultiByObjectType(SweepHits, Shape.PreviousSamples[i], CurrentSamples[i], FQuat::Identity,
+			ObjectParams, Sphere, QueryParams);
+		INC_DWORD_STAT(STAT_MeleeNumSweeps);
+
+		for (const FHitResult& Hit : SweepHits)
+		{
+			AActor* HitActor{ Hit.GetActor() };
+			if (HitActor == nullptr) continue;
+
+			//weapon and foot, or a blade passing through twice, only count once per swing
+			if (SwingHitActors.Contains(HitActor))
+			{
+				INC_DWORD_STAT(STAT_MeleeRepeatHits);
+				continue;
+			}
+
+			SwingHitActors.Add(HitActor);
+			INC_DWORD_STAT(STAT_MeleeHits);
+			OnMeleeHit.Broadcast(Hit, Shape.Name);
+		}
+	}
+
+	Swap(Shape.PreviousSamples, CurrentSamples);
+}
+
+void UMeleeTraceComponent::UpdateTickEnabled()
+{
+	const bool bAnyActive{ Shapes.ContainsByPredicate([](const FMeleeTraceShape& Shape) { return Shape.bActive; }) };
+	SetComponentTickEnabled(bSweepsEnabled && bAnyActive);
+}
@@ -0,0 +1,106 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "MeleeTraceComponent.generated.h"
+
+class USkeletalMeshComponent;
+
+DECLARE_STATS_GROUP(TEXT("Melee"), STATGROUP_Melee, STATCAT_Advanced);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FMeleeHitDelegate, const FHitResult&, HitResult, FName, ShapeName);
+
+//a striking part of the mesh, swept as spheres along the segment between two sockets
+USTRUCT(BlueprintType)
+struct FMeleeTraceShape
+{
+	GENERATED_BODY()
+
+	//name used by anim notifies to switch the shape on and off
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName Name;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName StartSocket;
+
+	//leave empty to sweep a single sphere at StartSocket
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FName EndSocket;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Radius = 10.f;
+
+	//spheres swept along the segment, more catch thin targets between the sockets on fast swings
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"))
+	int32 NumSamples = 3;
+
+	bool bActive = false;
+
+	//sample locations of the previous frame
+	TArray<FVector> PreviousSamples;
+};
+
+/**
+ * Detects melee hits by sweeping the active striking shapes from where they were last frame to where the
+ * animation put them this frame. Every actor is reported once per swing, no matter how many shapes touch it
+ * or how often it is touched. Needs no collision bodies of its own and only ticks while a shape is active.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class MEDIEVALGAMEENVIRONMENT_API UMeleeTraceComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UMeleeTraceComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	//mesh the sockets belong to
+	void SetMesh(USkeletalMeshComponent* Mesh);
+
+	void AddShape(const FMeleeTraceShape& Shape);
+
+	//clears the actors hit so far, call when a new attack starts
+	void BeginSwing();
+
+	void SetShapeActive(FName ShapeName, bool bActive);
+
+	//switches every shape off
+	void StopTracing();
+
+	//with sweeps off the shapes are still switched on and off but nothing is traced, so another hit detector
+	//can follow the anim notifies through GetShapes and report through OnMeleeHit
+	void SetSweepsEnabled(bool bEnabled);
+
+	FORCEINLINE const TArray<FMeleeTraceShape>& GetShapes() const { return Shapes; }
+
+	//broadcast the first time an actor is hit during the swing
+	UPROPERTY(BlueprintAssignable, Category = Delegates)
+	FMeleeHitDelegate OnMeleeHit;
+
+private:
+	void SampleShape(const FMeleeTraceShape& Shape, TArray<FVector>& OutSamples) const;
+	void SweepShape(FMeleeTraceShape& Shape);
+	void UpdateTickEnabled();
+
+	UPROPERTY()
+	USkeletalMeshComponent* TraceMesh;
+
+	UPROPERTY(EditAnywhere, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	TArray<FMeleeTraceShape> Shapes;
+
+	//object types the sweeps look for
+	UPROPERTY(EditAnywhere, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	TArray<TEnumAsByte<EObjectTypeQuery>> TargetObjectTypes;
+
+	bool bSweepsEnabled;
+
+	//actors already hit during the current swing
+	TSet<TWeakObjectPtr<AActor>> SwingHitActors;
+
+	//scratch buffers, kept to reuse the allocations
+	TArray<FVector> CurrentSamples;
+	TArray<FHitResult> SweepHits;
+};
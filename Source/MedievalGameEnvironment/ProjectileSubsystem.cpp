@@ -0,0 +1,331 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "ProjectileSubsystem.h"
+#include "Main.h"
+#include "Enemy.h"
+#include "FXPoolSubsystem.h"
+#include "HitEventSubsystem.h"
+#include "WhipHitInterface.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Process Trace Results"), STAT_ProjectileTraceResults, STATGROUP_Projectiles);
+DECLARE_CYCLE_STAT(TEXT("Integrate"), STAT_ProjectileIntegrate, STATGROUP_Projectiles);
+DECLARE_CYCLE_STAT(TEXT("Issue Traces"), STAT_ProjectileIssueTraces, STATGROUP_Projectiles);
+DECLARE_CYCLE_STAT(TEXT("Update Instances"), STAT_ProjectileUpdateInstances, STATGROUP_Projectiles);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Live Projectiles"), STAT_LiveProjectiles, STATGROUP_Projectiles);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Impacts"), STAT_ProjectileImpacts, STATGROUP_Projectiles);
+
+//below this the ParallelFor overhead isn't worth it
+static const int32 MinProjectilesForParallelIntegrate{ 512 };
+
+static void RunProjectileStress(const TArray<FString>& Args, UWorld* World)
+{
+	UProjectileSubsystem* Projectiles = World ? World->GetSubsystem<UProjectileSubsystem>() : nullptr;
+	if (Projectiles == nullptr) return;
+
+	const int32 Count{ Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 5000 };
+
+	//slow, long lived rounds so the requested number stays alive at the same time
+	static int32 StressType{ INDEX_NONE };
+	static TWeakObjectPtr<UProjectileSubsystem> StressTypeOwner;
+	if (StressType == INDEX_NONE || StressTypeOwner.Get() != Projectiles)
+	{
+		FProjectileParams Params;
+		Params.Speed = 1500.f;
+		Params.GravityScale = 0.1f;
+		Params.Lifetime = 10.f;
+		Params.Mesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
+		Params.MeshScale = FVector(0.05f);
+		StressType = Projectiles->RegisterProjectileType(Params);
+		StressTypeOwner = Projectiles;
+	}
+
+	const APawn* Player = UGameplayStatics::GetPlayerPawn(World, 0);
+	const FVector Origin{ (Player ? Player->GetActorLocation() : FVector::ZeroVector) + FVector(0.f, 0.f, 2000.f) };
+	FRandomStream Random(Count);
+	for (int32 i = 0; i < Count; i++)
+	{
+		Projectiles->FireProjectile(StressType, Origin, Random.GetUnitVector(), nullptr);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Projectile stress: launched %d projectiles, %d live. Use 'stat Projectiles' for timings."),
+		Count, Projectiles->GetNumProjectiles());
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GProjectileStressCommand(
+	TEXT("Projectile.Stress"),
+	TEXT("Launches projectiles in every direction above the player. Usage: Projectile.Stress [Count=5000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunProjectileStress));
+
+void UProjectileSubsystem::Deinitialize()
+{
+	if (RenderActor)
+	{
+		RenderActor->Destroy();
+		RenderActor = nullptr;
+	}
+	MeshComponents.Empty();
+
+	Super::Deinitialize();
+}
+
+int32 UProjectileSubsystem::RegisterProjectileType(const FProjectileParams& Params)
+{
+	return Types.Add(Params);
+}
+
+void UProjectileSubsystem::FireProjectile(int32 TypeIndex, const FVector& Location, const FVector& Direction, AActor* Instigator,
+	float TimeInFlight)
+{
+	if (!Types.IsValidIndex(TypeIndex)) return;
+
+	Positions.Add(Location);
+	Velocities.Add(Direction.GetSafeNormal() * Types[TypeIndex].Speed);
+	Ages.Add(0.f);
+	TypeIndices.Add(TypeIndex);
+	Instigators.Add(Instigator);
+	SegmentStarts.Add(Location);
+	TraceHandles.Add(FTraceHandle());
+	Dead.Add(false);
+	FirstSteps.Add(FMath::Max(TimeInFlight, 0.f));
+}
+
+void UProjectileSubsystem::Tick(float DeltaTime)
+{
+	ProcessTraceResults();
+	RemoveDeadProjectiles();
+	IntegrateProjectiles(DeltaTime);
+	IssueTraces();
+	RemoveDeadProjectiles();
+	UpdateInstances();
+
+	SET_DWORD_STAT(STAT_LiveProjectiles, Positions.Num());
+}
+
+void UProjectileSubsystem::ProcessTraceResults()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileTraceResults);
+
+	UWorld* World = GetWorld();
+	int32 NumImpacts{ 0 };
+	for (int32 i = 0; i < Positions.Num(); i++)
+	{
+		if (!TraceHandles[i].IsValid()) continue;
+
+		FTraceDatum TraceDatum;
+		if (World->QueryTraceData(TraceHandles[i], TraceDatum))
+		{
+			const FHitResult* HitResult = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits);
+			if (HitResult)
+			{
+				ApplyImpact(i, *HitResult);
+				NumImpacts++;
+			}
+		}
+		TraceHandles[i] = FTraceHandle();
+	}
+
+	SET_DWORD_STAT(STAT_ProjectileImpacts, NumImpacts);
+}
+
+void UProjectileSubsystem::IntegrateProjectiles(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileIntegrate);
+
+	const float GravityZ{ GetWorld()->GetGravityZ() };
+	const int32 Num{ Positions.Num() };
+	ParallelFor(Num, [this, DeltaTime, GravityZ](int32 i)
+	{
+		const FProjectileParams& Params = Types[TypeIndices[i]];
+
+		//shots fired during this frame have only been in flight since they were due
+		const float StepTime{ FirstSteps[i] >= 0.f ? FirstSteps[i] : DeltaTime };
+		FirstSteps[i] = -1.f;
+
+		SegmentStarts[i] = Positions[i];
+		Velocities[i].Z += GravityZ * Params.GravityScale * StepTime;
+		Positions[i] += Velocities[i] * StepTime;
+		Ages[i] += StepTime;
+		Dead[i] = Ages[i] > Params.Lifetime;
+	}, Num < MinProjectilesForParallelIntegrate);
+}
+
+void UProjectileSubsystem::IssueTraces()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileIssueTraces);
+
+	UWorld* World = GetWorld();
+	for (int32 i = 0; i < Positions.Num(); i++)
+	{
+		if (Dead[i]) continue;
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileTrace), false, Instigators[i].Get());
+		const FProjectileParams& Params = Types[TypeIndices[i]];
+		if (Params.CollisionRadius > 0.f)
+		{
+			TraceHandles[i] = World->AsyncSweepByChannel(EAsyncTraceType::Single, SegmentStarts[i], Positions[i], FQuat::Identity,
+				ECollisionChannel::ECC_Visibility, FCollisionShape::MakeSphere(Params.CollisionRadius), QueryParams);
+		}
+		else
+		{
+			TraceHandles[i] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, SegmentStarts[i], Positions[i],
+				ECollisionChannel::ECC_Visibility, QueryParams);
+		}
+	}
+}
+
+void UProjectileSubsystem::ApplyImpact(int32 Index, const FHitResult& HitResult)
+{
+	Dead[Index] = true;
+
+	const FProjectileParams& Params = Types[TypeIndices[Index]];
+	AActor* Instigator{ Instigators[Index].Get() };
+	AController* InstigatorController{ Instigator ? Instigator->GetInstigatorController() : nullptr };
+
+	//whip hit receivers play their own hit effects
+	AActor* HitActor{ HitResult.Actor.Get() };
+	const bool bHitReceiver{ HitActor && HitActor->GetClass()->ImplementsInterface(UWhipHitInterface::StaticClass()) };
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (Params.ImpactEffect && FXPool && !bHitReceiver)
+	{
+		FXPool->SpawnEmitterAtLocation(Params.ImpactEffect, HitResult.ImpactPoint, HitResult.ImpactNormal.Rotation());
+	}
+
+	if (Params.ExplosionRadius > 0.f)
+	{
+		UGameplayStatics::ApplyRadialDamage(this, Params.Damage, HitResult.ImpactPoint, Params.ExplosionRadius,
+			UDamageType::StaticClass(), TArray<AActor*>(), Instigator, InstigatorController);
+		return;
+	}
+
+	if (HitActor == nullptr) return;
+
+	//enemies hit by the character take the same hit zone damage as its hitscan shots
+	float HitDamage{ Params.Damage };
+	const AMain* MainCharacter = Cast<AMain>(Instigator);
+	const AEnemy* HitEnemy = Cast<AEnemy>(HitActor);
+	if (MainCharacter && HitEnemy)
+	{
+		HitDamage = MainCharacter->GetHitDamage(HitEnemy, HitResult);
+	}
+
+	UHitEventSubsystem* HitEvents = GetWorld()->GetSubsystem<UHitEventSubsystem>();
+	if (HitEvents)
+	{
+		HitEvents->QueueHit(HitResult, HitDamage, InstigatorController, Instigator);
+	}
+}
+
+void UProjectileSubsystem::RemoveDeadProjectiles()
+{
+	for (int32 i = Positions.Num() - 1; i >= 0; i--)
+	{
+		if (!Dead[i]) continue;
+
+		Positions.RemoveAtSwap(i, 1, false);
+		Velocities.RemoveAtSwap(i, 1, false);
+		Ages.RemoveAtSwap(i, 1, false);
+		TypeIndices.RemoveAtSwap(i, 1, false);
+		Instigators.RemoveAtSwap(i, 1, false);
+		SegmentStarts.RemoveAtSwap(i, 1, false);
+		TraceHandles.RemoveAtSwap(i, 1, false);
+		Dead.RemoveAtSwap(i, 1, false);
+		FirstSteps.RemoveAtSwap(i, 1, false);
+	}
+}
+
+UInstancedStaticMeshComponent* UProjectileSubsystem::GetMeshComponent(UStaticMesh* Mesh)
+{
+	if (UInstancedStaticMeshComponent** Found = MeshComponents.Find(Mesh))
+	{
+		return *Found;
+	}
+
+	if (RenderActor == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags = RF_Transient;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		RenderActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		RenderActor->SetRootComponent(NewObject<USceneComponent>(RenderActor, TEXT("Root"), RF_Transient));
+		RenderActor->GetRootComponent()->RegisterComponent();
+	}
+
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(RenderActor, NAME_None, RF_Transient);
+	Component->SetStaticMesh(Mesh);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetGenerateOverlapEvents(false);
+	Component->SetCastShadow(false);
+	Component->SetupAttachment(RenderActor->GetRootComponent());
+	Component->RegisterComponent();
+	MeshComponents.Add(Mesh, Component);
+	return Component;
+}
+
+void UProjectileSubsystem::UpdateInstances()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ProjectileUpdateInstances);
+
+	//instances aren't tied to projectiles, each mesh simply draws as many as there are live projectiles using it
+	NumDrawnInstances = 0;
+	for (int32 TypeIndex = 0; TypeIndex < Types.Num(); TypeIndex++)
+	{
+		const FProjectileParams& Params = Types[TypeIndex];
+		if (Params.Mesh == nullptr) continue;
+
+		InstanceTransforms.Reset();
+		for (int32 i = 0; i < Positions.Num(); i++)
+		{
+			if (TypeIndices[i] == TypeIndex)
+			{
+				InstanceTransforms.Emplace(Velocities[i].ToOrientationQuat(), Positions[i], Params.MeshScale);
+			}
+		}
+
+		UInstancedStaticMeshComponent* Component{ InstanceTransforms.Num() > 0 || MeshComponents.Contains(Params.Mesh)
+			? GetMeshComponent(Params.Mesh) : nullptr };
+		if (Component == nullptr) continue;
+
+		while (Component->GetInstanceCount() > InstanceTransforms.Num())
+		{
+			Component->RemoveInstance(Component->GetInstanceCount() - 1);
+		}
+		while (Component->GetInstanceCount() < InstanceTransforms.Num())
+		{
+			Component->AddInstance(FTransform::Identity);
+		}
+		NumDrawnInstances += Component->GetInstanceCount();
+		if (InstanceTransforms.Num() > 0)
+		{
+			Component->BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true, true);
+		}
+	}
+}
+
+bool UProjectileSubsystem::IsTickable() const
+{
+	//instances of the last projectiles are removed in the tick that kills them, so this only matters when the
+	//instance update was skipped
+	return Positions.Num() > 0 || NumDrawnInstances > 0;
+}
+
+ETickableTickType UProjectileSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UProjectileSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,128 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "ProjectileSubsystem.generated.h"
+
+class UStaticMesh;
+class UParticleSystem;
+class UInstancedStaticMeshComponent;
+
+DECLARE_STATS_GROUP(TEXT("Projectiles"), STATGROUP_Projectiles, STATCAT_Advanced);
+
+//how a kind of projectile flies, looks and hurts
+USTRUCT(BlueprintType)
+struct FProjectileParams
+{
+	GENERATED_BODY()
+
+	//muzzle speed in cm/s
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Speed = 10000.f;
+
+	//multiplier of the world gravity
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float GravityScale = 1.f;
+
+	//seconds before the projectile is removed without hitting anything
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Lifetime = 3.f;
+
+	//radius of the swept sphere, 0 traces a line
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CollisionRadius = 0.f;
+
+	//damage for actors that aren't enemies of a character instigator (which use the hit zone damage)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Damage = 20.f;
+
+	//explosives damage everything within this radius instead of the hit actor alone
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ExplosionRadius = 0.f;
+
+	//rendered as an instance of this mesh, nothing is rendered if unset
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UStaticMesh* Mesh = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector MeshScale = FVector(1.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UParticleSystem* ImpactEffect = nullptr;
+};
+
+/**
+ * Simulates travel-time projectiles without an actor per round. Live projectiles are kept in parallel arrays,
+ * integrated in a ParallelFor and traced asynchronously: the segment flown in one frame is traced during that
+ * frame and its hit is handled at the start of the next one.
+ */
+UCLASS()
+class MEDIEVALGAMEENVIRONMENT_API UProjectileSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	//adds a kind of projectile, returns the index to fire it with
+	int32 RegisterProjectileType(const FProjectileParams& Params);
+
+	//launches a projectile along Direction, the instigator is ignored by its traces and gets credit for the damage;
+	//TimeInFlight is how long before the end of the frame it was fired, its first step covers only that time
+	void FireProjectile(int32 TypeIndex, const FVector& Location, const FVector& Direction, AActor* Instigator,
+		float TimeInFlight = 0.f);
+
+	FORCEINLINE int32 GetNumProjectiles() const { return Positions.Num(); }
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	//handles the hits of last frame's traces
+	void ProcessTraceResults();
+
+	void IntegrateProjectiles(float DeltaTime);
+	void IssueTraces();
+	void ApplyImpact(int32 Index, const FHitResult& HitResult);
+	void RemoveDeadProjectiles();
+	void UpdateInstances();
+
+	UInstancedStaticMeshComponent* GetMeshComponent(UStaticMesh* Mesh);
+
+	UPROPERTY(Transient)
+	TArray<FProjectileParams> Types;
+
+	//one entry per live projectile, every array has the same length
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> Ages;
+	TArray<int32> TypeIndices;
+	TArray<TWeakObjectPtr<AActor>> Instigators;
+	TArray<FVector> SegmentStarts;
+	TArray<FTraceHandle> TraceHandles;
+	TArray<bool> Dead;
+
+	//length of the next integration step of projectiles fired this frame, negative once they use the frame time
+	TArray<float> FirstSteps;
+
+	//holds the instanced meshes the projectiles are drawn with
+	UPROPERTY(Transient)
+	AActor* RenderActor;
+
+	UPROPERTY(Transient)
+	TMap<UStaticMesh*, UInstancedStaticMeshComponent*> MeshComponents;
+
+	//per-frame scratch buffer, kept to reuse the allocation
+	TArray<FTransform> InstanceTransforms;
+
+	//instances left on the mesh components after the last update
+	int32 NumDrawnInstances = 0;
+};
@@ -0,0 +1,289 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "SignificanceSubsystem.h"
+#include "Enemy.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Update Buckets"), STAT_SignificanceUpdate, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registered Actors"), STAT_SignificanceRegistered, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Critical"), STAT_SignificanceCritical, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("High"), STAT_SignificanceHigh, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Medium"), STAT_SignificanceMedium, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Low"), STAT_SignificanceLow, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dormant"), STAT_SignificanceDormant, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Full AI LOD Enemies"), STAT_SignificanceAILODFull, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reduced AI LOD Enemies"), STAT_SignificanceAILODReduced, STATGROUP_Significance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Minimal AI LOD Enemies"), STAT_SignificanceAILODMinimal, STATGROUP_Significance);
+
+USignificanceSubsystem::USignificanceSubsystem() : UpdateInterval(0.25f), OffscreenDistanceScale(2.f), ViewConeAngle(60.f),
+	TimeSinceUpdate(0.f)
+{
+	FSignificanceBucketSettings& Critical = BucketSettings[static_cast<int32>(ESignificanceBucket::ESB_Critical)];
+	Critical.MaxDistance = 1500.f;
+
+	FSignificanceBucketSettings& High = BucketSettings[static_cast<int32>(ESignificanceBucket::ESB_High)];
+	High.MaxDistance = 3000.f;
+	High.TickInterval = 1.f / 30.f;
+
+	FSignificanceBucketSettings& Medium = BucketSettings[static_cast<int32>(ESignificanceBucket::ESB_Medium)];
+	Medium.MaxDistance = 6000.f;
+	Medium.TickInterval = 0.1f;
+	Medium.AnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+	Medium.AILODTier = EEnemyLODTier::EELT_Reduced;
+
+	FSignificanceBucketSettings& Low = BucketSettings[static_cast<int32>(ESignificanceBucket::ESB_Low)];
+	Low.MaxDistance = 12000.f;
+	Low.TickInterval = 0.25f;
+	Low.AnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	Low.AILODTier = EEnemyLODTier::EELT_Minimal;
+
+	FSignificanceBucketSettings& Dormant = BucketSettings[static_cast<int32>(ESignificanceBucket::ESB_Dormant)];
+	Dormant.MaxDistance = BIG_NUMBER;
+	Dormant.TickInterval = 1.f;
+	Dormant.bTickEnabled = false;
+	Dormant.AnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	Dormant.AILODTier = EEnemyLODTier::EELT_Minimal;
+
+	FMemory::Memzero(BucketCounts);
+	FMemory::Memzero(AILODTierCounts);
+}
+
+void USignificanceSubsystem::RegisterActor(AActor* Actor)
+{
+	if (Actor == nullptr) return;
+	if (Records.ContainsByPredicate([Actor](const FSignificanceRecord& Record) { return Record.Actor.Get() == Actor; })) return;
+
+	FSignificanceRecord& Record = Records.AddDefaulted_GetRef();
+	Record.Actor = Actor;
+	Record.BaseActorTickInterval = Actor->GetActorTickInterval();
+
+	TInlineComponentArray<UActorComponent*> Components(Actor);
+	for (UActorComponent* Component : Components)
+	{
+		if (Component && Component->PrimaryComponentTick.bCanEverTick)
+		{
+			Record.Components.Add(Component);
+			Record.BaseComponentIntervals.Add(Component->GetComponentTickInterval());
+		}
+
+		if (USkinnedMeshComponent* Mesh = Cast<USkinnedMeshComponent>(Component))
+		{
+			Record.Meshes.Add(Mesh);
+			Record.BaseAnimTickOptions.Add(Mesh->VisibilityBasedAnimTickOption);
+			Record.BaseUpdateRateOptimizations.Add(Mesh->bEnableUpdateRateOptimizations);
+		}
+	}
+
+	//new actors start at full rate until the next update scores them
+	BucketCounts[static_cast<int32>(ESignificanceBucket::ESB_Critical)]++;
+}
+
+void USignificanceSubsystem::UnregisterActor(AActor* Actor)
+{
+	const int32 Index{ Records.IndexOfByPredicate([Actor](const FSignificanceRecord& Record) { return Record.Actor.Get() == Actor; }) };
+	if (Index == INDEX_NONE) return;
+
+	BucketCounts[static_cast<int32>(Records[Index].Bucket)]--;
+	ApplyBucket(Records[Index], ESignificanceBucket::ESB_Critical);
+	Records.RemoveAtSwap(Index, 1, false);
+}
+
+int32 USignificanceSubsystem::GetNumInBucket(ESignificanceBucket Bucket) const
+{
+	return Bucket != ESignificanceBucket::ESB_MAX ? BucketCounts[static_cast<int32>(Bucket)] : 0;
+}
+
+void USignificanceSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceUpdate += DeltaTime;
+	if (TimeSinceUpdate < UpdateInterval) return;
+
+	TimeSinceUpdate = 0.f;
+	UpdateBuckets();
+}
+
+void USignificanceSubsystem::UpdateBuckets()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SignificanceUpdate);
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr) return;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	const FVector ViewDirection{ ViewRotation.Vector() };
+
+	FMemory::Memzero(BucketCounts);
+	FMemory::Memzero(AILODTierCounts);
+	for (int32 i = Records.Num() - 1; i >= 0; i--)
+	{
+		FSignificanceRecord& Record = Records[i];
+		const AActor* Actor{ Record.Actor.Get() };
+		if (Actor == nullptr)
+		{
+			Records.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		const ESignificanceBucket Bucket{ ScoreActor(Actor, ViewLocation, ViewDirection) };
+		if (Bucket != Record.Bucket)
+		{
+			ApplyBucket(Record, Bucket);
+		}
+		ApplyAILODTier(Record);
+		BucketCounts[static_cast<int32>(Bucket)]++;
+
+		if (const AEnemy* Enemy = Cast<AEnemy>(Actor))
+		{
+			AILODTierCounts[static_cast<int32>(Enemy->GetLODTier())]++;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_SignificanceRegistered, Records.Num());
+	SET_DWORD_STAT(STAT_SignificanceCritical, BucketCounts[static_cast<int32>(ESignificanceBucket::ESB_Critical)]);
+	SET_DWORD_STAT(STAT_SignificanceHigh, BucketCounts[static_cast<int32>(ESignificanceBucket::ESB_High)]);
+	SET_DWORD_STAT(STAT_SignificanceMedium, BucketCounts[static_cast<int32>(ESignificanceBucket::ESB_Medium)]);
+	SET_DWORD_STAT(STAT_SignificanceLow, BucketCounts[static_cast<int32>(ESignificanceBucket::ESB_Low)]);
+	SET_DWORD_STAT(STAT_SignificanceDormant, BucketCounts[static_cast<int32>(ESignificanceBucket::ESB_Dormant)]);
+	SET_DWORD_STAT(STAT_SignificanceAILODFull, AILODTierCounts[static_cast<int32>(EEnemyLODTier::EELT_Full)]);
+	SET_DWORD_STAT(STAT_SignificanceAILODReduced, AILODTierCounts[static_cast<int32>(EEnemyLODTier::EELT_Reduced)]);
+	SET_DWORD_STAT(STAT_SignificanceAILODMinimal, AILODTierCounts[static_cast<int32>(EEnemyLODTier::EELT_Minimal)]);
+}
+
+ESignificanceBucket USignificanceSubsystem::ScoreActor(const AActor* Actor, const FVector& ViewLocation,
+	const FVector& ViewDirection) const
+{
+	//enemies fighting the player always run at full rate, so do dying ones: their death montage has to
+	//reach the FinishDeath notify before they are parked or destroyed
+	const AEnemy* Enemy = Cast<AEnemy>(Actor);
+	if (Enemy && (Enemy->IsInCombat() || Enemy->IsDying())) return ESignificanceBucket::ESB_Critical;
+
+	const FVector ToActor{ Actor->GetActorLocation() - ViewLocation };
+	float Distance{ ToActor.Size() };
+	const bool bInView{ FVector::DotProduct(ToActor.GetSafeNormal(), ViewDirection) >= FMath::Cos(FMath::DegreesToRadians(ViewConeAngle)) };
+	if (!bInView)
+	{
+		Distance *= OffscreenDistanceScale;
+	}
+
+	for (int32 i = 0; i < static_cast<int32>(ESignificanceBucket::ESB_MAX); i++)
+	{
+		if (Distance < BucketSettings[i].MaxDistance)
+		{
+			return static_cast<ESignificanceBucket>(i);
+		}
+	}
+	return ESignificanceBucket::ESB_Dormant;
+}
+
+void USignificanceSubsystem::ApplyBucket(FSignificanceRecord& Record, ESignificanceBucket Bucket)
+{
+	AActor* Actor{ Record.Actor.Get() };
+	Record.Bucket = Bucket;
+	if (Actor == nullptr) return;
+
+	const FSignificanceBucketSettings& Settings = BucketSettings[static_cast<int32>(Bucket)];
+
+	//leaving dormancy: turn back on only what was ticking before
+	if (Settings.bTickEnabled)
+	{
+		if (Record.bActorTickDisabled)
+		{
+			Actor->SetActorTickEnabled(true);
+			Record.bActorTickDisabled = false;
+		}
+		for (const TWeakObjectPtr<UActorComponent>& Component : Record.DisabledComponents)
+		{
+			if (Component.IsValid())
+			{
+				Component->SetComponentTickEnabled(true);
+			}
+		}
+		Record.DisabledComponents.Reset();
+	}
+
+	Actor->SetActorTickInterval(FMath::Max(Record.BaseActorTickInterval, Settings.TickInterval));
+	if (!Settings.bTickEnabled && Actor->IsActorTickEnabled())
+	{
+		Actor->SetActorTickEnabled(false);
+		Record.bActorTickDisabled = true;
+	}
+
+	for (int32 i = 0; i < Record.Components.Num(); i++)
+	{
+		UActorComponent* Component{ Record.Components[i].Get() };
+		if (Component == nullptr) continue;
+
+		Component->SetComponentTickInterval(FMath::Max(Record.BaseComponentIntervals[i], Settings.TickInterval));
+
+		if (!Settings.bTickEnabled && Component->IsComponentTickEnabled())
+		{
+			//a character stopped mid-air would hang there until it wakes up
+			const UCharacterMovementComponent* Movement = Cast<UCharacterMovementComponent>(Component);
+			if (Movement && Movement->IsFalling()) continue;
+
+			Component->SetComponentTickEnabled(false);
+			Record.DisabledComponents.Add(Component);
+		}
+	}
+
+	ApplyMeshSettings(Record, Bucket);
+	ApplyAILODTier(Record);
+}
+
+void USignificanceSubsystem::ApplyAILODTier(FSignificanceRecord& Record)
+{
+	AEnemy* Enemy = Cast<AEnemy>(Record.Actor.Get());
+	if (Enemy == nullptr) return;
+
+	Enemy->SetLODTier(BucketSettings[static_cast<int32>(Record.Bucket)].AILODTier);
+}
+
+void USignificanceSubsystem::ApplyMeshSettings(FSignificanceRecord& Record, ESignificanceBucket Bucket)
+{
+	const FSignificanceBucketSettings& Settings = BucketSettings[static_cast<int32>(Bucket)];
+	for (int32 i = 0; i < Record.Meshes.Num(); i++)
+	{
+		USkinnedMeshComponent* Mesh{ Record.Meshes[i].Get() };
+		if (Mesh == nullptr) continue;
+
+		//critical actors get the mesh's own settings back, e.g. characters refresh bones off screen for the melee sweeps
+		if (Bucket == ESignificanceBucket::ESB_Critical)
+		{
+			Mesh->VisibilityBasedAnimTickOption = Record.BaseAnimTickOptions[i];
+			Mesh->bEnableUpdateRateOptimizations = Record.BaseUpdateRateOptimizations[i];
+			continue;
+		}
+
+		//later options update less, never make a mesh update more than it was set up to
+		Mesh->VisibilityBasedAnimTickOption = FMath::Max(Record.BaseAnimTickOptions[i], Settings.AnimTickOption);
+
+		//lets skinned meshes skip frames in the lower buckets
+		Mesh->bEnableUpdateRateOptimizations = true;
+	}
+}
+
+bool USignificanceSubsystem::IsTickable() const
+{
+	return Records.Num() > 0;
+}
+
+ETickableTickType USignificanceSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* USignificanceSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId USignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USignificanceSubsystem, STATGROUP_Tickables);
+}
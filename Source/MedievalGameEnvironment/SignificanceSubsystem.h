@@ -0,0 +1,141 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "EnemyLODTier.h"
+#include "SignificanceSubsystem.generated.h"
+
+class UActorComponent;
+
+DECLARE_STATS_GROUP(TEXT("Significance"), STATGROUP_Significance, STATCAT_Advanced);
+
+UENUM(BlueprintType)
+enum class ESignificanceBucket : uint8
+{
+	ESB_Critical UMETA(DisplayName = "Critical"),
+	ESB_High UMETA(DisplayName = "High"),
+	ESB_Medium UMETA(DisplayName = "Medium"),
+	ESB_Low UMETA(DisplayName = "Low"),
+	ESB_Dormant UMETA(DisplayName = "Dormant"),
+
+	ESB_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+//what an actor in a bucket is allowed to cost
+USTRUCT(BlueprintType)
+struct FSignificanceBucketSettings
+{
+	GENERATED_BODY()
+
+	//actors closer than this (after the off-screen scale) land in the bucket
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxDistance = 0.f;
+
+	//interval for the actor and component ticks, an actor's own longer interval is kept
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TickInterval = 0.f;
+
+	//dormant actors don't tick at all
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bTickEnabled = true;
+
+	//behavior tree, movement and timer detail of enemies in the bucket
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EEnemyLODTier AILODTier = EEnemyLODTier::EELT_Full;
+
+	//when skeletal meshes update their pose, a mesh that was already set to update less keeps its own option
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EVisibilityBasedAnimTickOption AnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+};
+
+//registered actor and the tick state it had before the subsystem touched it
+struct FSignificanceRecord
+{
+	TWeakObjectPtr<AActor> Actor;
+
+	float BaseActorTickInterval = 0.f;
+
+	//components that can tick, with their own interval
+	TArray<TWeakObjectPtr<UActorComponent>> Components;
+	TArray<float> BaseComponentIntervals;
+
+	//skinned meshes with their own anim tick option and update rate optimization flag, restored in the critical bucket
+	TArray<TWeakObjectPtr<USkinnedMeshComponent>> Meshes;
+	TArray<EVisibilityBasedAnimTickOption> BaseAnimTickOptions;
+	TArray<bool> BaseUpdateRateOptimizations;
+
+	//components (and the actor) that were ticking when the actor went dormant
+	TArray<TWeakObjectPtr<UActorComponent>> DisabledComponents;
+	bool bActorTickDisabled = false;
+
+	ESignificanceBucket Bucket = ESignificanceBucket::ESB_Critical;
+};
+
+/**
+ * Sorts registered actors into buckets by distance to the player, whether they are in view and whether
+ * they are fighting, and throttles actor ticks, component ticks (character movement included),
+ * skeletal mesh updates and the AI LOD tier of enemies per bucket. Actors are re-scored a few times per second,
+ * not every frame.
+ */
+UCLASS(Config = Game)
+class MEDIEVALGAMEENVIRONMENT_API USignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	USignificanceSubsystem();
+
+	void RegisterActor(AActor* Actor);
+
+	//restores the actor's tick state and stops managing it
+	void UnregisterActor(AActor* Actor);
+
+	int32 GetNumInBucket(ESignificanceBucket Bucket) const;
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	void UpdateBuckets();
+
+	ESignificanceBucket ScoreActor(const AActor* Actor, const FVector& ViewLocation, const FVector& ViewDirection) const;
+
+	void ApplyBucket(FSignificanceRecord& Record, ESignificanceBucket Bucket);
+
+	//anim tick option and update rate optimizations of the actor's skinned meshes
+	void ApplyMeshSettings(FSignificanceRecord& Record, ESignificanceBucket Bucket);
+
+	//enemies promote themselves on agro or damage, so the tier is checked on every update, not only on bucket changes
+	void ApplyAILODTier(FSignificanceRecord& Record);
+
+	TArray<FSignificanceRecord> Records;
+
+	UPROPERTY(Config)
+	FSignificanceBucketSettings BucketSettings[static_cast<int32>(ESignificanceBucket::ESB_MAX)];
+
+	//seconds between re-scoring all registered actors
+	UPROPERTY(Config)
+	float UpdateInterval;
+
+	//distance multiplier for actors outside the view cone
+	UPROPERTY(Config)
+	float OffscreenDistanceScale;
+
+	//half angle of the view cone in degrees
+	UPROPERTY(Config)
+	float ViewConeAngle;
+
+	float TimeSinceUpdate;
+
+	int32 BucketCounts[static_cast<int32>(ESignificanceBucket::ESB_MAX)];
+
+	int32 AILODTierCounts[static_cast<int32>(EEnemyLODTier::EELT_MAX)];
+};
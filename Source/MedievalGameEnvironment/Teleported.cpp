@@ -5,12 +5,15 @@
 #include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "FXPoolSubsystem.h"
+#include "CombatAudioSubsystem.h"
+#include "SignificanceSubsystem.h"
 
 // Sets default values
 ATeleported::ATeleported()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	//props don't tick
+	PrimaryActorTick.bCanEverTick = false;
 
 }
 
@@ -18,26 +21,48 @@ ATeleported::ATeleported()
 void ATeleported::BeginPlay()
 {
 	Super::BeginPlay();
+
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (FXPool)
+	{
+		FXPool->PrewarmTemplate(TeleportParticles);
+	}
+
+	UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+	if (CombatAudio)
+	{
+		CombatAudio->PreloadSound(ImpactSound, ECombatSoundCategory::ECSC_Impact);
+	}
+
+	if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>())
+	{
+		Significance->RegisterActor(this);
+	}
 	
 }
 
-// Called every frame
-void ATeleported::Tick(float DeltaTime)
+void ATeleported::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	if (USignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USignificanceSubsystem>())
+	{
+		Significance->UnregisterActor(this);
+	}
 
+	Super::EndPlay(EndPlayReason);
 }
 
-void ATeleported::WhipHit_Implementation(FHitResult HitResult)
+void ATeleported::WhipHit_Implementation(const FHitResult& HitResult)
 {
 
-	if (ImpactSound)
+	UCombatAudioSubsystem* CombatAudio = GetWorld()->GetSubsystem<UCombatAudioSubsystem>();
+	if (ImpactSound && CombatAudio)
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
+		CombatAudio->PlaySoundAtLocation(ImpactSound, GetActorLocation(), ECombatSoundCategory::ECSC_Impact);
 	}
-	if (TeleportParticles)
+	UFXPoolSubsystem* FXPool = GetWorld()->GetSubsystem<UFXPoolSubsystem>();
+	if (TeleportParticles && FXPool)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), TeleportParticles, HitResult.Location, FRotator(0.f), true);
+		FXPool->SpawnEmitterAtLocation(TeleportParticles, HitResult.Location);
 	}
 
 	Destroy();
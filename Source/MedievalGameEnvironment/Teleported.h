@@ -20,6 +20,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 
 	//teleportation when hit by whip
@@ -31,9 +33,6 @@ private:
 	class USoundCue* ImpactSound;
 
 public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
-	virtual void WhipHit_Implementation(FHitResult HitResult) override;
+	virtual void WhipHit_Implementation(const FHitResult& HitResult) override;
 
 };
@@ -2,30 +2,27 @@
 
 
 #include "Weapon.h"
+#include "GameplayDataSubsystem.h"
+#include "LootField.h"
+#include "CombatAudioSubsystem.h"
 
 AWeapon::AWeapon():
-	ThrowWeaponTime(0.7f), bFalling(false), Ammo(30), MagazineCapacity(30), WeaponType(EWeaponType::EWT_Snipper), 
+	SettleCheckInterval(0.25f), MaxFallTime(5.f), SettleSpeed(5.f), FallStartTime(0.f), bFalling(false), 
+	Ammo(30), MagazineCapacity(30), WeaponType(EWeaponType::EWT_Snipper), 
 	AmmoType(EAmmoType::EAT_9mm), ReloadMontageSection(FName(TEXT("Reload Snipper")))
 {
-	PrimaryActorTick.bCanEverTick = true;
-}
-
-void AWeapon::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
+	//the physics scene keeps the thrown weapon upright and reports when it lands, nothing to tick
+	PrimaryActorTick.bCanEverTick = false;
 
-	//keep the weapon upright
-	if (GetItemState() == EItemState::EIS_Falling && bFalling)
-	{
-		const FRotator MeshRotation{ 0.f, GetItemMesh()->GetComponentRotation().Yaw, 0.f };
-		GetItemMesh()->SetWorldRotation(MeshRotation, false, nullptr, ETeleportType::TeleportPhysics);
-	}
+	GetItemMesh()->BodyInstance.bGenerateWakeEvents = true;
+	GetItemMesh()->OnComponentSleep.AddDynamic(this, &AWeapon::OnMeshSleep);
 }
 
 void AWeapon::ThrowWeapon()
 {
 	FRotator MeshRotation{ 0.f, GetItemMesh()->GetComponentRotation().Yaw, 0.f };
 	GetItemMesh()->SetWorldRotation(MeshRotation, false, nullptr, ETeleportType::TeleportPhysics);
+	SetUprightLock(true);
 
 	const FVector MeshForward{ GetItemMesh()->GetForwardVector() };
 	const FVector MeshRight{ GetItemMesh()->GetRightVector() };
@@ -38,7 +35,51 @@ void AWeapon::ThrowWeapon()
 	GetItemMesh()->AddImpulse(Impulse);
 
 	bFalling = true;
-	GetWorldTimerManager().SetTimer(ThrowWeaponTimer, this, &AWeapon::StopFalling, ThrowWeaponTime);
+	FallStartTime = GetWorld()->GetTimeSeconds();
+	GetWorldTimerManager().SetTimer(SettleCheckTimer, this, &AWeapon::CheckSettled, SettleCheckInterval, true);
+}
+
+void AWeapon::SetUprightLock(bool bLock)
+{
+	USkeletalMeshComponent* Mesh{ GetItemMesh() };
+	//skeletal bodies come from the physics asset, so the lock goes on each of them
+	for (FBodyInstance* Body : Mesh->Bodies)
+	{
+		if (Body == nullptr) continue;
+
+		Body->bLockXRotation = bLock;
+		Body->bLockYRotation = bLock;
+		Body->bGenerateWakeEvents = true;
+		Body->SetDOFLock(bLock ? EDOFMode::SixDOF : EDOFMode::None);
+	}
+}
+
+void AWeapon::OnMeshSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	if (bFalling)
+	{
+		StopFalling();
+	}
+}
+
+void AWeapon::CheckSettled()
+{
+	//picked up or pooled while still falling
+	if (!bFalling || GetItemState() != EItemState::EIS_Falling)
+	{
+		bFalling = false;
+		GetWorldTimerManager().ClearTimer(SettleCheckTimer);
+		SetUprightLock(false);
+		return;
+	}
+
+	const bool bResting{ !GetItemMesh()->RigidBodyIsAwake() ||
+		GetItemMesh()->GetPhysicsLinearVelocity().SizeSquared() < FMath::Square(SettleSpeed) };
+	const bool bTimedOut{ GetWorld()->GetTimeSeconds() - FallStartTime > MaxFallTime };
+	if (bResting || bTimedOut)
+	{
+		StopFalling();
+	}
 }
 
 void AWeapon::DecrementAmmo()
@@ -62,42 +103,92 @@ void AWeapon::ReloadAmmo(int32 Amount)
 void AWeapon::StopFalling()
 {
 	bFalling = false;
+	GetWorldTimerManager().ClearTimer(SettleCheckTimer);
+	SetUprightLock(false);
 	SetItemState(EItemState::EIS_Pickup);
+
+	//settled weapons far from the player can go back to being loot instances
+	if (ALootField* LootField = ALootField::Find(GetWorld()))
+	{
+		LootField->TrackWeapon(this);
+	}
+}
+
+FDehydratedWeapon AWeapon::Dehydrate() const
+{
+	FDehydratedWeapon Record;
+	Record.WeaponClass = GetClass();
+	Record.WeaponType = WeaponType;
+	Record.ItemRarity = GetItemRarity();
+	Record.Ammo = Ammo;
+	Record.SlotIndex = GetSlotIndex();
+	Record.ItemIcon = GetItemIcon();
+	Record.AmmoIcon = GetAmmoIcon();
+	return Record;
+}
+
+void AWeapon::Rehydrate(const FDehydratedWeapon& Record)
+{
+	WeaponType = Record.WeaponType;
+	SetItemRarity(Record.ItemRarity);
+	ApplyWeaponData();
+
+	//the table resets the ammo, restore what was left in the magazine (negative keeps the table value)
+	if (Record.Ammo >= 0)
+	{
+		Ammo = FMath::Min(Record.Ammo, MagazineCapacity);
+	}
+	SetSlotIndex(Record.SlotIndex);
 }
 
 void AWeapon::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
-	const FString WeaponTablePath{TEXT("DataTable'/Game/Assets/DataTable/WeaponDataTable.WeaponDataTable'")};
-	UDataTable* WeaponTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, *WeaponTablePath));
 
-	if (WeaponTableObject)
+	ApplyWeaponData();
+}
+
+void AWeapon::ApplyWeaponData()
+{
+	FGameplayDataRegistry& Registry = UGameplayDataSubsystem::GetRegistry(this);
+	const FWeaponDataTable* WeaponDataRow = Registry.GetWeaponData(WeaponType);
+	if (WeaponDataRow)
 	{
-		FWeaponDataTable* WeaponDataRow = nullptr;
-		switch (WeaponType)
-		{
-		case EWeaponType::EWT_Snipper:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("Snipper"), TEXT(""));
-			break;
-		case EWeaponType::EWT_AssaultRiffle:
-			WeaponDataRow = WeaponTableObject->FindRow<FWeaponDataTable>(FName("AssaultRifle"), TEXT(""));
-			break;
-		}
+		AmmoType = WeaponDataRow->AmmoType;
+		Ammo = WeaponDataRow->WeaponAmmo;
+		MagazineCapacity = WeaponDataRow->MagazineCapacity;
+		SetItemName(WeaponDataRow->ItemName);
+		SetClipBoneName(WeaponDataRow->ClipBoneName);
+		SetReloadMontageSection(WeaponDataRow->ReloadMontageSection);
+
+		//runs right away if the assets are already in memory
+		Registry.RequestWeaponAssets(WeaponType, FSimpleDelegate::CreateUObject(this, &AWeapon::ApplyWeaponAssets));
+	}
+}
+
+void AWeapon::ApplyWeaponAssets()
+{
+	const FGameplayDataRegistry& Registry = UGameplayDataSubsystem::GetRegistry(this);
+	//the weapon type may have changed while the assets were loading
+	if (Registry.GetWeaponAssetState(WeaponType) != EWeaponAssetState::EWAS_Loaded) return;
+
+	const FWeaponDataTable* WeaponDataRow = Registry.GetWeaponData(WeaponType);
+	if (WeaponDataRow)
+	{
+		SetPickupSound(WeaponDataRow->PickupSound.Get());
+		SetEquipSound(WeaponDataRow->EquipSound.Get());
+		GetItemMesh()->SetSkeletalMesh(WeaponDataRow->ItemMesh.Get());
+		SetItemIcon(WeaponDataRow->InventoryIcon.Get());
+		SetAmmoIcon(WeaponDataRow->AmmoIcon.Get());
+		GetItemMesh()->SetAnimInstanceClass(WeaponDataRow->AnimBP.Get());
 
-		if (WeaponDataRow)
+		//also runs from OnConstruction in the editor, only game worlds play sounds
+		UWorld* World = GetWorld();
+		UCombatAudioSubsystem* CombatAudio = World && World->IsGameWorld() ? World->GetSubsystem<UCombatAudioSubsystem>() : nullptr;
+		if (CombatAudio)
 		{
-			AmmoType = WeaponDataRow->AmmoType;
-			Ammo = WeaponDataRow->WeaponAmmo;
-			MagazineCapacity = WeaponDataRow->MagazineCapacity;
-			SetPickupSound(WeaponDataRow->PickupSound);
-			SetEquipSound(WeaponDataRow->EquipSound);
-			GetItemMesh()->SetSkeletalMesh(WeaponDataRow->ItemMesh);
-			SetItemName(WeaponDataRow->ItemName);
-			SetItemIcon(WeaponDataRow->InventoryIcon);
-			SetAmmoIcon(WeaponDataRow->AmmoIcon);
-			SetClipBoneName(WeaponDataRow->ClipBoneName);
-			SetReloadMontageSection(WeaponDataRow->ReloadMontageSection);
-			GetItemMesh()->SetAnimInstanceClass(WeaponDataRow->AnimBP);
+			CombatAudio->PreloadSound(GetPickupSound(), ECombatSoundCategory::ECSC_Interface);
+			CombatAudio->PreloadSound(GetEquipSound(), ECombatSoundCategory::ECSC_Interface);
 		}
 	}
 }
@@ -9,6 +9,9 @@
 #include "WeaponType.h"
 #include "Weapon.generated.h"
 
+class USoundCue;
+class USkeletalMesh;
+class UAnimInstance;
 
 USTRUCT(BlueprintType)
 struct FWeaponDataTable : public FTableRowBase
@@ -24,23 +27,24 @@ struct FWeaponDataTable : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int32 MagazineCapacity;
 
+	//assets are soft so loading the table doesn't load every weapon, see FGameplayDataRegistry::RequestWeaponAssets
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	class USoundCue* PickupSound;
+	TSoftObjectPtr<USoundCue> PickupSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundCue* EquipSound;
+	TSoftObjectPtr<USoundCue> EquipSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USkeletalMesh* ItemMesh;
+	TSoftObjectPtr<USkeletalMesh> ItemMesh;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FString ItemName;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* InventoryIcon;
+	TSoftObjectPtr<UTexture2D> InventoryIcon;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* AmmoIcon;
+	TSoftObjectPtr<UTexture2D> AmmoIcon;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FName ClipBoneName;
@@ -49,7 +53,40 @@ struct FWeaponDataTable : public FTableRowBase
 	FName ReloadMontageSection;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSubclassOf<UAnimInstance> AnimBP;
+	TSoftClassPtr<UAnimInstance> AnimBP;
+};
+
+//what is left of an unequipped weapon while it sits in the inventory without an actor
+USTRUCT(BlueprintType)
+struct FDehydratedWeapon
+{
+	GENERATED_BODY()
+
+	//class to respawn the weapon from
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TSubclassOf<class AWeapon> WeaponClass;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	EWeaponType WeaponType = EWeaponType::EWT_Snipper;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	EItemRarity ItemRarity = EItemRarity::EIR_Common;
+
+	//ammo left in the magazine, negative for the weapon table default
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Ammo = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 SlotIndex = INDEX_NONE;
+
+	//kept so the inventory bar can draw the slot without an actor
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UTexture2D* ItemIcon = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UTexture2D* AmmoIcon = nullptr;
+
+	FORCEINLINE bool IsValid() const { return WeaponClass != nullptr; }
 };
 
 /**
@@ -61,16 +98,44 @@ class MEDIEVALGAMEENVIRONMENT_API AWeapon : public AItem
 	GENERATED_BODY()
 public:
 	AWeapon();
-	virtual void Tick(float DeltaTime) override;
 
 protected:
 	void StopFalling();
 
+	//locks roll and pitch of the simulated bodies so the weapon lands upright
+	void SetUprightLock(bool bLock);
+
+	//rigid body went to sleep, the weapon has come to rest
+	UFUNCTION()
+	void OnMeshSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	//backup for bodies that don't report sleep events, settles the weapon once it stopped moving or fell too long
+	void CheckSettled();
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 
+	//copies the row for WeaponType from the gameplay data registry onto this weapon and requests its assets
+	void ApplyWeaponData();
+
+	//sets mesh, sounds, icons and anim class once the assets of WeaponType are loaded
+	void ApplyWeaponAssets();
+
 private:
-	FTimerHandle ThrowWeaponTimer;
-	float ThrowWeaponTime;
+	FTimerHandle SettleCheckTimer;
+
+	//seconds between checks of the falling weapon's rest state
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	float SettleCheckInterval;
+
+	//falling weapons are turned into pickups after this long even if they never came to rest
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	float MaxFallTime;
+
+	//below this speed (cm/s) the weapon counts as resting
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties", meta = (AllowPrivateAccess = "true"))
+	float SettleSpeed;
+
+	float FallStartTime;
 	bool bFalling;
 
 	//ammo count for this weapon
@@ -125,5 +190,11 @@ public:
 	void ReloadAmmo(int32 Amount);
 
 	FORCEINLINE void SetMovingClip(bool Move) { bMovingClip = Move; }
+
+	//records everything needed to bring this weapon back once its actor is gone
+	FDehydratedWeapon Dehydrate() const;
+
+	//turns this (pooled) actor into the weapon described by the record
+	void Rehydrate(const FDehydratedWeapon& Record);
 	
 };
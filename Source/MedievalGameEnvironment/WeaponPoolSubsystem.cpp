@@ -0,0 +1,61 @@
+// Licensed for use with Unreal Engine products only
+
+
+#include "WeaponPoolSubsystem.h"
+#include "Weapon.h"
+#include "Engine/World.h"
+
+UWeaponPoolSubsystem::UWeaponPoolSubsystem() : MaxPooledPerClass(4)
+{
+}
+
+AWeapon* UWeaponPoolSubsystem::AcquireWeapon(TSubclassOf<AWeapon> WeaponClass, const FTransform& Transform)
+{
+	if (WeaponClass == nullptr) return nullptr;
+
+	FPooledWeapons* Pool = Pools.Find(WeaponClass);
+	while (Pool && Pool->Weapons.Num() > 0)
+	{
+		AWeapon* Weapon = Pool->Weapons.Pop(false);
+		if (Weapon && !Weapon->IsPendingKill())
+		{
+			Weapon->SetActorTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+			Weapon->SetActorHiddenInGame(false);
+			Weapon->SetActorTickEnabled(Weapon->PrimaryActorTick.bStartWithTickEnabled);
+			return Weapon;
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<AWeapon>(WeaponClass, Transform, SpawnParams);
+}
+
+void UWeaponPoolSubsystem::ReleaseWeapon(AWeapon* Weapon)
+{
+	if (Weapon == nullptr || Weapon->IsPendingKill()) return;
+
+	FPooledWeapons& Pool = Pools.FindOrAdd(Weapon->GetClass());
+	if (Pool.Weapons.Num() >= MaxPooledPerClass)
+	{
+		Weapon->Destroy();
+		return;
+	}
+
+	//picked up state hides the mesh and turns off every collision
+	Weapon->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Weapon->SetItemState(EItemState::EIS_PickedUp);
+	Weapon->SetActorHiddenInGame(true);
+	Weapon->SetActorTickEnabled(false);
+	Pool.Weapons.Add(Weapon);
+}
+
+int32 UWeaponPoolSubsystem::GetNumPooled() const
+{
+	int32 NumPooled{ 0 };
+	for (const auto& Pair : Pools)
+	{
+		NumPooled += Pair.Value.Weapons.Num();
+	}
+	return NumPooled;
+}
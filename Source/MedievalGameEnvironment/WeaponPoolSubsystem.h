@@ -0,0 +1,47 @@
+// Licensed for use with Unreal Engine products only
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WeaponPoolSubsystem.generated.h"
+
+class AWeapon;
+
+//idle weapon actors of one class
+USTRUCT()
+struct FPooledWeapons
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<AWeapon*> Weapons;
+};
+
+/**
+ * Keeps a few hidden, collision-free weapon actors per class around so weapons that are
+ * rehydrated from the inventory (or promoted from loot) don't have to be spawned from scratch.
+ */
+UCLASS()
+class MEDIEVALGAMEENVIRONMENT_API UWeaponPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponPoolSubsystem();
+
+	//returns an idle weapon of the class, spawning one if the pool is empty
+	AWeapon* AcquireWeapon(TSubclassOf<AWeapon> WeaponClass, const FTransform& Transform);
+
+	//hides the weapon and keeps it for reuse, or destroys it when the pool for its class is full
+	void ReleaseWeapon(AWeapon* Weapon);
+
+	int32 GetNumPooled() const;
+
+private:
+	UPROPERTY(Transient)
+	TMap<UClass*, FPooledWeapons> Pools;
+
+	//idle weapons kept per class
+	int32 MaxPooledPerClass;
+};
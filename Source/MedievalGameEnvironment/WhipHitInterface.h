@@ -24,6 +24,6 @@ class MEDIEVALGAMEENVIRONMENT_API IWhipHitInterface
 public:
 
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable)
-	void WhipHit(FHitResult HitResult);
+	void WhipHit(const FHitResult& HitResult);
 
 };